@@ -39,15 +39,18 @@ task main()
   DisplayInit();
   RobotInit();
   //
-  // Wait for the beginning of autonomous mode.
+  // Pick the autonomous routine and wait for the beginning of autonomous
+  // mode.
   //
+  AutoMenu();
   waitForStart();
   SMStart(g_AutoSM);
+  SchedStart(g_Sched);
   while (true)
   {
     InputTasks(false);
     MainTasks();
     OutputTasks();
-    wait10Msec(1);
+    SchedWait(g_Sched);
   }
 }   //main
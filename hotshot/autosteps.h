@@ -0,0 +1,155 @@
+#if 0
+/// Copyright (c) Titan Robotics Club. All rights reserved.
+///
+/// <module name="autosteps.h" />
+///
+/// <summary>
+///   This module contains the autonomous step tables compiled from
+///   auto.scr (generated by tools/scrc.c, do not edit).
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   The rows are packed as in lib/script.h, 510 bytes in all.
+/// </remarks>
+#endif
+
+#define NUM_AUTOSCRIPTS         4
+
+string g_AutoNames[NUM_AUTOSCRIPTS] =
+{
+  "BlueLeft",
+  "BlueRight",
+  "RedLeft",
+  "RedRight"
+};
+
+int g_AutoFlags[NUM_AUTOSCRIPTS] =
+{
+  0,
+  0,
+  0,
+  0
+};
+
+int g_AutoTimes[NUM_AUTOSCRIPTS] =   //in msec
+{
+  20930,
+  17870,
+  15890,
+  19010
+};
+
+int g_AutoSteps[] =
+{
+  //
+  // BlueLeft: 11 steps, about 20.9 sec.
+  //
+  // drive -96 @50 (4.2 sec)
+  SCROP_DRIVE,                      -96, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        8500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // drive 24 @50 (1.1 sec)
+  SCROP_DRIVE,                       24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // turn 90 @50 (1.0 sec)
+  SCROP_TURN,                        90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive 72 @50 (3.2 sec)
+  SCROP_DRIVE,                       72, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        6500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive 24 @50 & spinup @100 (1.1 sec)
+  SCROP_DRIVE | SCROPF_PARALLEL,     24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  SCROP_SPINUP,                       0, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SPUNUP),           500,   0,
+  // shoot 2000 @100 (2.0 sec)
+  SCROP_SHOOT,                     2000, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED),    4000,   0,
+  // turn 180 @50 (1.9 sec)
+  SCROP_TURN,                       180, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           4000,   0,
+  // drive -72 @50 (3.2 sec)
+  SCROP_DRIVE,                      -72, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        6500,   0,
+  // end
+  SCROP_END,                          0, SCRWAIT(0, EVTTYPE_NONE, 0),                                  0,   0,
+  //
+  // BlueRight: 12 steps, about 17.9 sec.
+  //
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // turn 90 @50 (1.0 sec)
+  SCROP_TURN,                        90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // drive 24 @50 (1.1 sec)
+  SCROP_DRIVE,                       24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // turn 180 @50 (1.9 sec)
+  SCROP_TURN,                       180, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           4000,   0,
+  // drive -24 @50 & spinup @100 (1.1 sec)
+  SCROP_DRIVE | SCROPF_PARALLEL,    -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  SCROP_SPINUP,                       0, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SPUNUP),           500,   0,
+  // shoot 2000 @100 (2.0 sec)
+  SCROP_SHOOT,                     2000, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED),    4000,   0,
+  // drive -48 @50 (2.1 sec)
+  SCROP_DRIVE,                      -48, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        4500,   0,
+  // turn 90 @50 (1.0 sec)
+  SCROP_TURN,                        90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -72 @50 (3.2 sec)
+  SCROP_DRIVE,                      -72, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        6500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // end
+  SCROP_END,                          0, SCRWAIT(0, EVTTYPE_NONE, 0),                                  0,   0,
+  //
+  // RedLeft: 10 steps, about 15.9 sec.
+  //
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // drive 48 @50 & spinup @100 (2.1 sec)
+  SCROP_DRIVE | SCROPF_PARALLEL,     48, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        4500,   0,
+  SCROP_SPINUP,                       0, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SPUNUP),           500,   0,
+  // shoot 2000 @100 (2.0 sec)
+  SCROP_SHOOT,                     2000, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED),    4000,   0,
+  // drive 48 @50 (2.1 sec)
+  SCROP_DRIVE,                       48, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        4500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive 72 @50 (3.2 sec)
+  SCROP_DRIVE,                       72, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        6500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // end
+  SCROP_END,                          0, SCRWAIT(0, EVTTYPE_NONE, 0),                                  0,   0,
+  //
+  // RedRight: 10 steps, about 19.0 sec.
+  //
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -48 @50 & spinup @100 (2.1 sec)
+  SCROP_DRIVE | SCROPF_PARALLEL,    -48, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        4500,   0,
+  SCROP_SPINUP,                       0, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SPUNUP),           500,   0,
+  // shoot 2000 @100 (2.0 sec)
+  SCROP_SHOOT,                     2000, SCRWAIT(100, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED),    4000,   0,
+  // drive -48 @50 (2.1 sec)
+  SCROP_DRIVE,                      -48, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        4500,   0,
+  // drive 96 @50 (4.2 sec)
+  SCROP_DRIVE,                       96, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        8500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive 72 @50 (3.2 sec)
+  SCROP_DRIVE,                       72, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        6500,   0,
+  // turn -90 @50 (1.0 sec)
+  SCROP_TURN,                       -90, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE),           2500,   0,
+  // drive -24 @50 (1.1 sec)
+  SCROP_DRIVE,                      -24, SCRWAIT(50, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE),        2500,   0,
+  // end
+  SCROP_END,                          0, SCRWAIT(0, EVTTYPE_NONE, 0),                                  0,   0
+};
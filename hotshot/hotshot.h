@@ -15,15 +15,56 @@
 #define MAX_LIGHT_SENSORS       3
 #define MAX_LNFOLLOW_ACTIONS    27
 
-//#include "..\drivers\LEGOLS-driver.h"
-#include "..\lib\common.h"
-#include "..\lib\trace.h"
-#include "..\lib\button.h"
-#include "..\lib\display.h"
-#include "..\lib\sensor.h"
-#include "..\lib\drive.h"
-#include "..\lib\sm.h"
-#include "..\lib\lnfollow.h"
+//
+// App module IDs. They are defined ahead of the includes because the
+// compile-time trace configuration below uses them, and the lib headers
+// expand their trace points as they are included.
+//
+#define MOD_SHOOTER             TGenModId(1)
+
+//
+// Compile-time trace configuration. Only the main and shooter trace points
+// are compiled in, so the lib modules don't pay for the runtime checks in
+// the loop.
+//
+#define TRACE_CT_MODULES        (MOD_MAIN | MOD_SHOOTER)
+#define TRACE_CT_HIFREQ         MOD_SHOOTER
+
+//
+// The include paths use forward slashes. RobotC accepts them as well as
+// backslashes, and the host builds in sim/ can then compile the same files.
+// Define USE_HTSMUX to read the light sensors through a HiTechnic SMUX on
+// S4. The #pragma config of the main module must then declare S4 as the
+// SMUX (HTSmux, sensorI2CCustom) in place of the light sensors on S2 to S4.
+//
+#ifdef USE_HTSMUX
+  #include "../drivers/LEGOLS-driver.h"
+#endif
+//
+// Define GYRO_SENSOR as the sensor port of a HiTechnic gyro to hold the
+// heading of the PID drive with it. The light sensors take all the free
+// ports unless they are on the SMUX, so the gyro needs USE_HTSMUX and the
+// #pragma config must declare its port.
+//
+#ifdef GYRO_SENSOR
+  #ifndef USE_HTSMUX
+    #error GYRO_SENSOR needs USE_HTSMUX to free a sensor port for the gyro.
+  #endif
+  #include "../drivers/HTGYRO-driver.h"
+#endif
+#include "../lib/common.h"
+#include "../lib/trace.h"
+#include "../lib/profile.h"
+#include "../lib/sched.h"
+#include "../lib/button.h"
+#include "../lib/replay.h"
+#include "../lib/display.h"
+#include "../lib/sensor.h"
+#include "../lib/drive.h"
+#include "../lib/sm.h"
+#include "../lib/evtbus.h"
+#include "../lib/script.h"
+#include "../lib/lnfollow.h"
 #include "shooter.h"
 
 #pragma systemFile
@@ -33,6 +74,53 @@
 #endif
 #define MOD_ID                  MOD_MAIN
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_EVTBUSDELIVER       (FIDBASE_MAIN + 0)
+#define FID_BUTTONEVENT         (FIDBASE_MAIN + 1)
+#define FID_SENSOREVENT         (FIDBASE_MAIN + 2)
+#define FID_DRIVEEVENT          (FIDBASE_MAIN + 3)
+#define FID_SHOOTEREVENT        (FIDBASE_MAIN + 4)
+#define FID_SCRIPTUSEROP        (FIDBASE_MAIN + 5)
+#define FID_AUTONOMOUSSM        (FIDBASE_MAIN + 6)
+#define FID_INITAUTOSCRIPTS     (FIDBASE_MAIN + 7)
+#define FID_AUTOMENU            (FIDBASE_MAIN + 8)
+#define FID_INITLNFOLLOWACTIONS (FIDBASE_MAIN + 9)
+#define FID_ROBOTINIT           (FIDBASE_MAIN + 10)
+#define FID_INPUTTASKS          (FIDBASE_MAIN + 11)
+#define FID_MAINTASKS           (FIDBASE_MAIN + 12)
+#define FID_OUTPUTTASKS         (FIDBASE_MAIN + 13)
+
+#ifdef _TRACE_FUNCNAMES
+string g_HotshotFuncNames[14] =
+{
+  "EvtBusDeliver",
+  "ButtonEvent",
+  "SensorEvent",
+  "DriveEvent",
+  "ShooterEvent",
+  "ScriptUserOp",
+  "AutonomousSM",
+  "InitAutoScripts",
+  "AutoMenu",
+  "InitLnFollowActions",
+  "RobotInit",
+  "InputTasks",
+  "MainTasks",
+  "OutputTasks"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_HotshotFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Trace info.
 //
@@ -40,6 +128,61 @@
 #define TRACE_LEVEL             FUNC
 #define MSG_LEVEL               INFO
 
+//
+// Scheduler info.
+//
+#define LOOP_PERIOD             10              //in msec
+#define SCHEDTASK_BUTTON        0
+#define SCHEDTASK_DRIVE         1
+#define SCHEDTASK_SHOOTER       2
+#define BUTTON_PERIOD           10              //in msec
+#define DRIVE_PERIOD            10              //in msec
+#define SHOOTER_PERIOD          10              //in msec
+
+//
+// The autonomous state machine also runs at the end of OutputTasks when the
+// events of the output tasks end a step, so the next step starts in the
+// same loop cycle instead of the next one. Define AUTO_CHAIN as false to
+// only run it in MainTasks.
+//
+#ifndef AUTO_CHAIN
+  #define AUTO_CHAIN            true
+#endif
+
+//
+// Replay info. The log is recorded by default so that a failure seen in a
+// match can be replayed. Define RPL_MODE as RPLMODE_REPLAY to replay it.
+//
+#ifndef RPL_MODE
+  #define RPL_MODE              RPLMODE_RECORD
+#endif
+#ifndef RPL_FILE_NAME
+  #define RPL_FILE_NAME         "hotshot.rpl"
+#endif
+
+//
+// Profile info.
+//
+#define PRFID_INPUT             (PRFID_USER + 1)
+#define PRFID_MAIN              (PRFID_USER + 2)
+#define PRFID_OUTPUT            (PRFID_USER + 3)
+
+//
+// Display info.
+//
+#define DISPPAGE_DRIVE          0
+#define DISPPAGE_SHOOTER        1
+#define DISPPAGE_SCHED          2
+#define DISPSLOT_STATE          (DISPSLOT_USER + 0)
+#define DISPSLOT_ENCLEFT        (DISPSLOT_USER + 1)
+#define DISPSLOT_ENCRIGHT       (DISPSLOT_USER + 2)
+#define DISPSLOT_SHOOTER        (DISPSLOT_USER + 3)
+#define DISPSLOT_FEEDER         (DISPSLOT_USER + 4)
+#define DISPSLOT_ROLLER         (DISPSLOT_USER + 5)
+#define DISPSLOT_ELEVATOR       (DISPSLOT_USER + 6)
+#define DISPSLOT_OVERRUNS       (DISPSLOT_USER + 7)
+#define DISPSLOT_MAXLATE        (DISPSLOT_USER + 8)
+
 //
 // State machine event types.
 //
@@ -48,6 +191,11 @@
 #define EVTTYPE_DRIVE           (EVTTYPE_NONE + 3)
 #define EVTTYPE_SHOOTER         (EVTTYPE_NONE + 4)
 
+//
+// Event bus subscribers, one for each state machine.
+//
+#define SUBID_AUTO              0
+
 //
 // Game info.
 //
@@ -55,6 +203,18 @@
 #define STARTPOS_BLUE_RIGHT     1
 #define STARTPOS_RED_LEFT       2
 #define STARTPOS_RED_RIGHT      3
+#define NUM_STARTPOS            4
+
+//
+// Autonomous script info.
+//
+#define SCROP_SHOOT             (SCROP_USER + 0)        //shoot param msec
+#define SCROP_SPINUP            (SCROP_USER + 1)        //spin up the shooter
+#define SCROP_PICKUP            (SCROP_USER + 2)        //pick up param msec
+#ifndef AUTO_FILE_NAME
+  #define AUTO_FILE_NAME        "auto.stp"
+#endif
+#define AUTOMENU_POLL           50      //in msec
 
 //
 // Drive info.
@@ -69,6 +229,60 @@
 #define KP                      0.3
 #define KI                      0.0
 #define KD                      0.0
+//
+// The PID of the drive runs in fixed point since the NXT has no floating
+// point unit.
+//
+#ifndef DRIVE_FLAGS
+  #define DRIVE_FLAGS           (DRIVEF_ENABLE_EVENTS | DRIVEF_FIXED_PID)
+#endif
+//
+// Motion profile limits of the PID drive, for the travel of each wheel.
+// A move at @N cruises at N% of the velocity limit with its power limited
+// to N, so @N goes about as fast with and without the profile. The
+// velocity is just under the free speed, and the acceleration about 2/3
+// of what the motors give from a stop. The feed-forward supplies most of
+// the power, so the PID needs little left to track the profile. Define
+// DRIVE_PROFILE as false to drive without the profile.
+//
+#ifndef DRIVE_PROFILE
+  #define DRIVE_PROFILE         true
+#endif
+#define DRIVE_VEL_MAX           46.0            //in inches/sec
+#define DRIVE_ACC_MAX           300.0           //in inches/sec^2
+//
+// Feed-forward gains of the PID drive on the motion profile. The wheels go
+// about 47 inches/sec at full power and the motors lag the power by about
+// 100 msec. Define DRIVE_FEEDFORWARD as false to drive on the PID alone.
+//
+#ifndef DRIVE_FEEDFORWARD
+  #define DRIVE_FEEDFORWARD     true
+#endif
+#define DRIVE_KV                2.1             //in power per inches/sec
+#define DRIVE_KA                0.21            //in power per inches/sec^2
+//
+// Completion criteria of the PID drive moves. A move is done when the
+// robot has settled within the tolerance of the target instead of when
+// the P loop has crawled all the way in. The step timeouts of the scripts
+// limit the moves, so there is no maximum duration. Define DRIVE_TOLERANCE
+// as false to end the moves on the PID power only.
+//
+#ifndef DRIVE_TOLERANCE
+  #define DRIVE_TOLERANCE       true
+#endif
+#define DRIVE_TOL_DISTANCE      1.0             //in inches
+#define DRIVE_TOL_ANGLE         2.0             //in degrees
+#define DRIVE_TOL_VEL           15.0            //in inches/sec
+#define DRIVE_SETTLE_TIME       10              //in msec
+#define DRIVE_TIME_MAX          0               //in msec
+//
+// Heading hold of the PID drive with the gyro (GYRO_SENSOR). Define
+// DRIVE_HEADING_HOLD as false to keep the robot straight on the encoders
+// only.
+//
+#ifndef DRIVE_HEADING_HOLD
+  #define DRIVE_HEADING_HOLD    true
+#endif
 
 //
 // Shooter info.
@@ -140,13 +354,88 @@
 //
 bool      g_fCalDrive = false;
 int       g_StartPos = STARTPOS_BLUE_LEFT;
+SCHED     g_Sched;
 BUTTON    g_Buttons1;
 BUTTON    g_Buttons2;
 DRIVE     g_Drive;
 SHOOTER   g_Shooter;
 SM        g_AutoSM;
+EVTBUS    g_EvtBus;
+EVTQUEUE  g_EvtQueue;
+SCRIPT    g_AutoScript;
+SCRLIB    g_AutoLib;
 LNFOLLOW  g_LnFollow;
 
+//
+// Autonomous scripts compiled into the program, one for each start
+// position in STARTPOS order. They are compiled from auto.scr by
+// tools/scrc.c, which also sets the step timeouts from the estimated step
+// times. Edit auto.scr and run
+// "scrc -b auto.stp hotshot/auto.scr hotshot/autosteps.h" to change the
+// routines. The robot runs the routines of the step file auto.stp when it
+// is on the NXT, so more routines can be carried in the file than in the
+// program, and only falls back to these.
+//
+#include "autosteps.h"
+
+/// <summary>
+///   This function delivers an event from the event bus to the state
+///   machine of the subscriber.
+/// </summary>
+///
+/// <param name="idSub">
+///   Specifies the subscriber ID.
+/// </param>
+/// <param name="evtType">
+///   Specifies the event type.
+/// </param>
+/// <param name="evtID">
+///   Specifies the event ID.
+/// </param>
+/// <param name="evtData">
+///   Specifies the event data.
+/// </param>
+/// <param name="evtParam1">
+///   Specifies the event parameter 1.
+/// </param>
+/// <param name="evtParam2">
+///   Specifies the event parameter 2.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+EvtBusDeliver(
+  __in int idSub,
+  __in int evtType,
+  __in int evtID,
+  __in int evtData,
+  __in int evtParam1,
+  __in int evtParam2
+  )
+{
+  TFuncId(FID_EVTBUSDELIVER);
+  TEnterMsg(EVENT, ("Sub=%d,Type=%x", idSub, evtType));
+
+  switch (idSub)
+  {
+    case SUBID_AUTO:
+      //
+      // The waits of the autonomous state machine are cleared when it is
+      // stopped, so it ignores the events outside of autonomous mode.
+      //
+      SMSetEvent(g_AutoSM, evtType, evtID, evtData, evtParam1, evtParam2);
+      break;
+
+    default:
+      TErr(("Invalid Sub=%d", idSub));
+      break;
+  }
+
+  TExit(EVENT);
+  return;
+}   //EvtBusDeliver
+
 /// <summary>
 ///   This function handles the button notification events.
 /// </summary>
@@ -162,11 +451,13 @@ ButtonEvent(
   __in BUTTON &button
   )
 {
-  TFuncName("ButtonEvent");
+  TFuncId(FID_BUTTONEVENT);
   TEnterMsg(EVENT, ("Button=%x,On=%d", button.maskButton, (byte)button.fPressed));
 
   int dirPickup = 1;  //Specifies the direction of the pickup motors.
 
+  EvtQueuePost(g_EvtQueue, EVTTYPE_BUTTON, button.maskButton,
+               (int)button.fPressed, button.idJoystick, 0);
   if (button.idJoystick == 1)
   {
     switch (button.maskButton)
@@ -263,6 +554,32 @@ ButtonEvent(
         }
         break;
 
+      case Logitech_Btn9:
+        if (button.fPressed)
+        {
+          //
+          // Switch to the next display page.
+          //
+          DisplayNextPage();
+        }
+        break;
+
+      case Logitech_Btn10:
+        if (button.fPressed)
+        {
+          //
+          // Dump the cycle time and function profiles and the trace
+          // sample drop counts to the debug stream. This also closes the
+          // input log so that it can be uploaded.
+          //
+          PrfDump();
+          PrfFuncDump();
+          TraceSampleDump();
+          RplClose();
+          RplDump();
+        }
+        break;
+
       default:
         break;
     }
@@ -315,11 +632,15 @@ ButtonEvent(
         break;
 
       case Logitech_LB7:
-        dirPickup = -1;
+      case Logitech_LB5:
         //
-        // Let it fall through.
+        // LB5 runs the pickup forward and LB7 runs it in reverse.
         //
-      case Logitech_LB5:
+        if (button.maskButton == Logitech_LB7)
+        {
+          dirPickup = -1;
+        }
+
         if (IsSMDisabled(g_AutoSM))
         {
           //
@@ -370,13 +691,12 @@ SensorEvent(
   __in SENSOR &sensor
   )
 {
-  TFuncName("SensorEvent");
+  TFuncId(FID_SENSOREVENT);
   TEnterMsg(EVENT, ("Sensor=%d,Zone=%d", sensor.idSensor, sensor.zoneSensor));
 
-  //
-  // Currently unused but we must declare this function since the sensor
-  // module will call it.
-  //
+  EvtQueuePost(g_EvtQueue, EVTTYPE_SENSOR, sensor.idSensor,
+               sensor.zoneSensor, 0, 0);
+
 #if 0
   switch (sensor.idSensor)
   {
@@ -404,19 +724,11 @@ DriveEvent(
   __in DRIVE &drive
   )
 {
-  TFuncName("DriveEvent");
+  TFuncId(FID_DRIVEEVENT);
   TEnterMsg(EVENT, ("Mode=%d", drive.modeDrive));
 
-  if (IsSMEnabled(g_AutoSM))
-  {
-    //
-    // In Autonomous mode, forward drive event to the
-    // autonomous state machine to unblock waiters waiting
-    // for this event.
-    //
-    SMSetEvent(g_AutoSM, EVTTYPE_DRIVE, drive.modeDrive, 0, 0, 0);
-  }
-  else
+  EvtQueuePost(g_EvtQueue, EVTTYPE_DRIVE, drive.modeDrive, 0, 0, 0);
+  if (IsSMDisabled(g_AutoSM))
   {
     switch (drive.modeDrive)
     {
@@ -449,309 +761,73 @@ ShooterEvent(
   __in SHOOTER &shooter
   )
 {
-  TFuncName("ShooterEvent");
+  TFuncId(FID_SHOOTEREVENT);
   TEnterMsg(EVENT, ("Evt=%d", shooter.event));
 
-  if (IsSMEnabled(g_AutoSM))
-  {
-    //
-    // In Autonomous mode, forward shooter event to the
-    // autonomous state machine to unblock waiters waiting
-    // for this event.
-    //
-    SMSetEvent(g_AutoSM, EVTTYPE_SHOOTER, shooter.event, 0, 0, 0);
-  }
+  EvtQueuePost(g_EvtQueue, EVTTYPE_SHOOTER, shooter.event, 0, 0, 0);
 
   TExit(EVENT);
   return;
 }   //ShooterEvent
 
 /// <summary>
-///   This function implements the autonomous mode with a start position
-///   on the left of the blue alliance.
+///   This function carries out the robot specific opcodes of the autonomous
+///   scripts.
 /// </summary>
 ///
-/// <param name="sm">
-///   Points to the SM structure.
+/// <param name="script">
+///   Points to the SCRIPT structure.
 /// </param>
-///
-/// <returns> None. </returns>
-///
-/// <remarks>
-///   Strategy:
-/// </remarks>
-
-void
-AutoBlueLeft(
-  __inout SM &sm
-  )
-{
-  TFuncName("AutoBlueLeft");
-  TEnter(HIFREQ);
-
-  switch (sm.currState)
-  {
-    case SMSTATE_STARTED:
-      //
-      // Move backward 8 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -96.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 1:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 2:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 3:
-      //
-      // Move forward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 4:
-      //
-      // Turn right 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, 90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 5:
-      //
-      // Move forward 6 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 72.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 6:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 7:
-      //
-      // Move forward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 8:
-      //
-      // Shoot high goal for 2-second.
-      //
-      ShooterSetShootPower(g_Shooter, SHOOTER_HIGH_POWER, FEEDER_POWER, 2000);
-      SMAddWaitEvent(sm, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 9:
-      //
-      // Turn right 180-degree.
-      //
-      DrivePIDSetAngle(g_Drive, 180.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 10:
-      //
-      // Move backward 6 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -72.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 11:
-      //
-      // We are done.
-      //
-      SMStop(sm);
-      break;
-
-    default:
-      break;
-  }
-
-  TExit(HIFREQ);
-  return;
-}   //AutoBlueLeft
-
-/// <summary>
-///   This function implements the autonomous mode with a start position
-///   on the right of the blue alliance.
-/// </summary>
-///
-/// <param name="sm">
-///   Points to the SM structure.
+/// <param name="opcode">
+///   Specifies the opcode of the step.
+/// </param>
+/// <param name="param">
+///   Specifies the parameter of the step.
+/// </param>
+/// <param name="power">
+///   Specifies the power of the step.
 /// </param>
 ///
-/// <returns> None. </returns>
-
-void
-AutoBlueRight(
-  __inout SM &sm
+/// <returns> Returns true if the opcode is valid. </returns>
+
+bool
+ScriptUserOp(
+  __inout SCRIPT &script,
+  __in int opcode,
+  __in int param,
+  __in int power
   )
 {
-  TFuncName("AutoBlueRight");
-  TEnter(HIFREQ);
-
-  switch (sm.currState)
-  {
-    case SMSTATE_STARTED:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 1:
-      //
-      // Turn right 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, 90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 2:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
+  TFuncId(FID_SCRIPTUSEROP);
+  TEnterMsg(FUNC, ("Op=%d,Param=%d", opcode, param));
 
-    case SMSTATE_STARTED + 3:
-      //
-      // Move forward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
+  bool fValid = true;
 
-    case SMSTATE_STARTED + 4:
-      //
-      // Turn right 180-degree.
-      //
-      DrivePIDSetAngle(g_Drive, 180.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 5:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 6:
-      //
-      // Shoot high goal for 2-second.
-      //
-      ShooterSetShootPower(g_Shooter, SHOOTER_HIGH_POWER, FEEDER_POWER, 2000);
-      SMAddWaitEvent(sm, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 7:
-      //
-      // Move backward 4 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -48.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 8:
-      //
-      // Turn right 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, 90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 9:
-      //
-      // Move backward 6 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -72.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 10:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
+  switch (opcode)
+  {
+    case SCROP_SHOOT:
+      ShooterSetShootPower(g_Shooter, power, FEEDER_POWER, param);
       break;
 
-    case SMSTATE_STARTED + 11:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
+    case SCROP_SPINUP:
+      ShooterSetShootPower(g_Shooter, power, 0, 0);
       break;
 
-    case SMSTATE_STARTED + 12:
-      //
-      // We are done.
-      //
-      SMStop(sm);
+    case SCROP_PICKUP:
+      ShooterSetPickupPower(g_Shooter, power, power, param);
       break;
 
     default:
+      fValid = false;
       break;
   }
 
-  TExit(HIFREQ);
-  return;
-}   //AutoBlueRight
+  TExitMsg(FUNC, ("fOK=%d", (byte)fValid));
+  return fValid;
+}   //ScriptUserOp
 
 /// <summary>
-///   This function implements the autonomous mode with a start position
-///   on the left of the red alliance.
+///   This function implements the state machine for autonomous mode.
 /// </summary>
 ///
 /// <param name="sm">
@@ -759,307 +835,208 @@ AutoBlueRight(
 /// </param>
 ///
 /// <returns> None. </returns>
-///
-/// <remarks>
-///   Strategy:
-/// </remarks>
 
 void
-AutoRedLeft(
+AutonomousSM(
   __inout SM &sm
   )
 {
-  TFuncName("AutoRedLeft");
+  TFuncId(FID_AUTONOMOUSSM);
   TEnter(HIFREQ);
 
-  switch (sm.currState)
+  SMTimerTask(sm);
+  for (int nRuns = 0; IsSMReady(sm) && (nRuns < MAX_SM_CHAIN); ++nRuns)
   {
-    case SMSTATE_STARTED:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 1:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 2:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 3:
-      //
-      // Move forward 4 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 48.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 4:
-      //
-      // Shoot high goal for 2-second.
-      //
-      ShooterSetShootPower(g_Shooter, SHOOTER_HIGH_POWER, FEEDER_POWER, 2000);
-      SMAddWaitEvent(sm, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 5:
-      //
-      // Move forward 4 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 48.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 6:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 7:
-      //
-      // Move forward 6 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 72.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 8:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
+    //
+    // We only execute the autonomous state machine if it is not in wait mode.
+    // The states are run to completion, so a state that doesn't wait goes
+    // on to the next one right away.
+    //
+    int i;
+    int wait;
+    bool fParallel;
 
-    case SMSTATE_STARTED + 9:
+    if (sm.currState == SMSTATE_STARTED)
+    {
       //
-      // Move backward 2 ft.
+      // Pick the script of the start position on the first step.
       //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
+      if ((g_StartPos >= 0) && (g_StartPos < g_AutoLib.nRoutines))
+      {
+        ScriptInit(g_AutoScript,
+                   g_AutoLib.Routines[g_StartPos].iFirst,
+                   g_AutoLib.Routines[g_StartPos].flagsScript);
+      }
+      else
+      {
+        TErr(("Invalid StartPos"));
+        SMStop(sm);
+      }
+    }
+    //
+    // Start all the parallel actions of the step.
+    //
+    fParallel = IsSMEnabled(sm);
+    while (fParallel)
+    {
+      i = ScriptStepIndex(g_AutoScript);
+      wait = g_AutoLib.Steps[i + SCRCOL_WAIT];
+      fParallel = ScriptStep(g_AutoScript, sm, g_Drive,
+                             g_AutoLib.Steps[i + SCRCOL_OP],
+                             g_AutoLib.Steps[i + SCRCOL_PARAM],
+                             ScriptPower(wait),
+                             ScriptEvtType(wait),
+                             ScriptEvtID(wait),
+                             g_AutoLib.Steps[i + SCRCOL_TIMEOUT],
+                             g_AutoLib.Steps[i + SCRCOL_TIMEOUT_STATE]);
+    }
 
-    case SMSTATE_STARTED + 10:
+    if (IsSMDisabled(sm))
+    {
       //
-      // We are done.
+      // The autonomous routine is done, dump the profiles and the event
+      // latencies and close the input log.
       //
-      SMStop(sm);
-      break;
-
-    default:
-      break;
+      SMLatencyDump(sm);
+      EvtQueueDump(g_EvtQueue);
+      PrfDump();
+      PrfFuncDump();
+      TraceSampleDump();
+      RplClose();
+      RplDump();
+    }
   }
 
   TExit(HIFREQ);
   return;
-}   //AutoRedLeft
+}   //AutonomousSM
 
 /// <summary>
-///   This function implements the autonomous mode with a start position
-///   on the right of the red alliance.
+///   This function loads the autonomous routines from the step file. If the
+///   file is not on the NXT, the routines compiled into the program are
+///   copied to the library instead, finding the first step of each one by
+///   its SCROP_END step.
 /// </summary>
 ///
-/// <param name="sm">
-///   Points to the SM structure.
-/// </param>
-///
 /// <returns> None. </returns>
-///
-/// <remarks>
-///   Strategy:
-/// </remarks>
 
 void
-AutoRedRight(
-  __inout SM &sm
-  )
+InitAutoScripts()
 {
-  TFuncName("AutoRedRight");
-  TEnter(HIFREQ);
+  TFuncId(FID_INITAUTOSCRIPTS);
+  TEnter(INIT);
 
-  switch (sm.currState)
+  if (!ScriptLibLoad(g_AutoLib, AUTO_FILE_NAME))
   {
-    case SMSTATE_STARTED:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 1:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 2:
-      //
-      // Move backward 4 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -48.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 3:
-      //
-      // Shoot high goal for 2-second.
-      //
-      ShooterSetShootPower(g_Shooter, SHOOTER_HIGH_POWER, FEEDER_POWER, 2000);
-      SMAddWaitEvent(sm, EVTTYPE_SHOOTER, SHOOTEREVT_SHOOTSTOPPED, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 4:
-      //
-      // Move backward 4 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -48.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 5:
-      //
-      // Move forward 8 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 96.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 6:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 7:
-      //
-      // Move forward 6 ft.
-      //
-      DrivePIDSetDistance(g_Drive, 72.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 8:
-      //
-      // Turn left 90-degree.
-      //
-      DrivePIDSetAngle(g_Drive, -90.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_ANGLE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
+    int nInts = ARRAYSIZE(g_AutoSteps);
+    int iStep = 0;
 
-    case SMSTATE_STARTED + 9:
-      //
-      // Move backward 2 ft.
-      //
-      DrivePIDSetDistance(g_Drive, -24.0, 50);
-      SMAddWaitEvent(sm, EVTTYPE_DRIVE, DRIVEMODE_PID_DISTANCE, -1);
-      SMWaitEvents(sm, sm.currState + 1, SMF_CLEAR_EVENTS);
-      break;
-
-    case SMSTATE_STARTED + 10:
-      //
-      // We are done.
-      //
-      SMStop(sm);
-      break;
+    for (int i = 0; i < NUM_AUTOSCRIPTS; ++i)
+    {
+      g_AutoLib.Routines[i].name = g_AutoNames[i];
+      g_AutoLib.Routines[i].iFirst = iStep;
+      g_AutoLib.Routines[i].flagsScript = g_AutoFlags[i];
+      g_AutoLib.Routines[i].timeEst = g_AutoTimes[i];
+      while ((iStep < nInts) &&
+             (g_AutoSteps[iStep + SCRCOL_OP] != SCROP_END))
+      {
+        iStep += SCRSTEP_SIZE;
+      }
+      iStep += SCRSTEP_SIZE;
+    }
 
-    default:
-      break;
+    for (int i = 0; i < nInts; ++i)
+    {
+      g_AutoLib.Steps[i] = g_AutoSteps[i];
+    }
+    g_AutoLib.nRoutines = NUM_AUTOSCRIPTS;
+    g_AutoLib.nInts = nInts;
   }
 
-  TExit(HIFREQ);
+  TExitMsg(INIT, ("Routines=%d,Load=%d", g_AutoLib.nRoutines, g_AutoLib.timeLoad));
   return;
-}   //AutoRedRight
+}   //InitAutoScripts
 
 /// <summary>
-///   This function implements the state machine for autonomous mode.
+///   This function lets the operator pick the autonomous routine with the
+///   NXT buttons before the match starts. The left and right buttons go
+///   through the routines and the enter button picks one. The menu starts
+///   on the routine of g_StartPos and ends with the routine shown when the
+///   match starts, so the robot never misses the start in the menu.
 /// </summary>
 ///
-/// <param name="sm">
-///   Points to the SM structure.
-/// </param>
-///
 /// <returns> None. </returns>
 
 void
-AutonomousSM(
-  __inout SM &sm
-  )
+AutoMenu()
 {
-  TFuncName("AutonomousSM");
-  TEnter(HIFREQ);
+  TFuncId(FID_AUTOMENU);
+  TEnter(INIT);
+
+  int nRoutines = g_AutoLib.nRoutines;
+  int iRoutine = ((g_StartPos >= 0) && (g_StartPos < nRoutines))?
+                 g_StartPos: 0;
+  int btnPrev = nNxtButtonPressed;
+  bool fRedraw = true;
+  bool fDone = (nRoutines == 0);
 
-  if (IsSMReady(sm))
+  DisplayHold(true);
+  while (!fDone)
   {
+    int btn = nNxtButtonPressed;
+
+    if (fRedraw)
+    {
+      eraseDisplay();
+      nxtDisplayTextLine(0, "Auto %d/%d", iRoutine + 1, nRoutines);
+      nxtDisplayTextLine(1, "%s", g_AutoLib.Routines[iRoutine].name);
+      nxtDisplayTextLine(2, "About %d.%d sec",
+                         g_AutoLib.Routines[iRoutine].timeEst/1000,
+                         (g_AutoLib.Routines[iRoutine].timeEst%1000)/100);
+      nxtDisplayTextLine(4, "Loaded in %d ms", g_AutoLib.timeLoad);
+      nxtDisplayTextLine(7, "<    Enter    >");
+      fRedraw = false;
+    }
     //
-    // We only execute the autonomous state machine if it is not in wait mode.
+    // Act on the button when it is pressed, not while it is held.
     //
-//    LnFollowTask(g_LnFollow);
-    switch (g_StartPos)
+    if (btn != btnPrev)
     {
-      case STARTPOS_BLUE_LEFT:
-        AutoBlueLeft(sm);
-        break;
-
-      case STARTPOS_BLUE_RIGHT:
-        AutoBlueRight(sm);
-        break;
-
-      case STARTPOS_RED_LEFT:
-        AutoRedLeft(sm);
-        break;
-
-      case STARTPOS_RED_RIGHT:
-        AutoRedRight(sm);
-        break;
+      switch (btn)
+      {
+        case kLeftButton:
+          iRoutine = (iRoutine + nRoutines - 1)%nRoutines;
+          fRedraw = true;
+          break;
+
+        case kRightButton:
+          iRoutine = (iRoutine + 1)%nRoutines;
+          fRedraw = true;
+          break;
+
+        case kEnterButton:
+          fDone = true;
+          break;
+      }
+      btnPrev = btn;
+    }
 
-      default:
-        TErr(("Invalid StartPos"));
-        break;
+    getJoystickSettings(joystick);
+    if (!joystick.StopPgm)
+    {
+      fDone = true;
+    }
+    else if (!fDone)
+    {
+      wait1Msec(AUTOMENU_POLL);
     }
   }
+  g_StartPos = iRoutine;
+  DisplayHold(false);
 
-  TExit(HIFREQ);
+  TExitMsg(INIT, ("Routine=%d", iRoutine));
   return;
-}   //AutonomousSM
+}   //AutoMenu
 
 /// <summary>
 ///   This function initializes the Line Follower action table.
@@ -1070,7 +1047,7 @@ AutonomousSM(
 void
 InitLnFollowActions()
 {
-  TFuncName("InitLnFollowActions");
+  TFuncId(FID_INITLNFOLLOWACTIONS);
   TEnter(INIT);
 
   LFInitInvalid(g_LnFollow, 0);         //0,0,0
@@ -1114,10 +1091,35 @@ InitLnFollowActions()
 void
 RobotInit()
 {
-  TFuncName("RobotInit");
+  TFuncId(FID_ROBOTINIT);
   TEnter(INIT);
 
-#ifdef HTSMUX_STATUS
+  //
+  // Initialize the profilers.
+  //
+  PrfFuncReset();
+  PrfInit();
+  PrfSetName(PRFID_SHOOTER, "ShooterTask");
+  PrfSetName(PRFID_INPUT, "InputTasks");
+  PrfSetName(PRFID_MAIN, "MainTasks");
+  PrfSetName(PRFID_OUTPUT, "OutputTasks");
+
+  //
+  // Sample the high frequency trace points so that they don't flood the
+  // debug stream when they are turned on.
+  //
+  TraceSampleInit(TSMPID_BUTTON, TSAMPLE_CHANGE, 0);
+  TraceSampleInit(TSMPID_SENSOR, TSAMPLE_EVERY, 10);
+  TraceSampleInit(TSMPID_DRIVE, TSAMPLE_RATE, 5);
+  TraceSampleInit(TSMPID_LNFOLLOW, TSAMPLE_RATE, 5);
+  TraceSampleInit(TSMPID_SHOOTER, TSAMPLE_RATE, 5);
+  //
+  // Initialize the input recorder before the subsystems, which start
+  // their clocks from the time of the log.
+  //
+  RplInit(RPL_MODE, RPL_FILE_NAME);
+
+#ifdef USE_HTSMUX
   //
   // Initialize the SMUX.
   //
@@ -1142,7 +1144,7 @@ RobotInit()
   InitLnFollowActions();
   LnFollowInit(g_LnFollow, MAX_LIGHT_SENSORS);
   SensorInit(g_LnFollow.LightSensors[0],
-#ifdef HTSMUX_STATUS
+#ifdef USE_HTSMUX
              msensor_S4_1,
 #else
              lightLeft,
@@ -1150,12 +1152,12 @@ RobotInit()
              THRESHOLD_LO_LEFTLIGHT,
              THRESHOLD_HI_LEFTLIGHT,
              SENSORF_INVERSE
-#ifdef HTSMUX_STATUS
+#ifdef USE_HTSMUX
              | SENSORF_HTSMUX
 #endif
              );
   SensorInit(g_LnFollow.LightSensors[1],
-#ifdef HTSMUX_STATUS
+#ifdef USE_HTSMUX
              msensor_S4_2,
 #else
              lightCenter,
@@ -1163,12 +1165,12 @@ RobotInit()
              THRESHOLD_LO_CENTERLIGHT,
              THRESHOLD_HI_CENTERLIGHT,
              SENSORF_INVERSE
-#ifdef HTSMUX_STATUS
+#ifdef USE_HTSMUX
              | SENSORF_HTSMUX
 #endif
              );
   SensorInit(g_LnFollow.LightSensors[2],
-#ifdef HTSMUX_STATUS
+#ifdef USE_HTSMUX
              msensor_S4_3,
 #else
              lightRight,
@@ -1176,7 +1178,7 @@ RobotInit()
              THRESHOLD_LO_RIGHTLIGHT,
              THRESHOLD_HI_RIGHTLIGHT,
              SENSORF_INVERSE
-#ifdef HTSMUX_STATUS
+#ifdef USE_HTSMUX
              | SENSORF_HTSMUX
 #endif
              );
@@ -1194,7 +1196,39 @@ RobotInit()
             CLICKS_PER_DISTANCE,
             CLICKS_PER_DEGREE,
             KP, KI, KD,
-            DRIVEF_ENABLE_EVENTS);
+            DRIVE_FLAGS);
+  if (DRIVE_PROFILE)
+  {
+    DriveSetProfile(g_Drive, DRIVE_VEL_MAX, DRIVE_ACC_MAX);
+  }
+  if (DRIVE_FEEDFORWARD)
+  {
+    DriveSetFeedForward(g_Drive, DRIVE_KV, DRIVE_KA);
+  }
+  if (DRIVE_TOLERANCE)
+  {
+    DriveSetTolerance(g_Drive,
+                      DRIVE_TOL_DISTANCE,
+                      DRIVE_TOL_ANGLE,
+                      DRIVE_TOL_VEL,
+                      DRIVE_SETTLE_TIME,
+                      DRIVE_TIME_MAX);
+  }
+#ifdef GYRO_SENSOR
+  if (DRIVE_HEADING_HOLD)
+  {
+    //
+    // The robot must be still while the gyro is calibrated.
+    //
+    HTGYROstartCal(GYRO_SENSOR);
+    DriveSetGyro(g_Drive, GYRO_SENSOR);
+  }
+#endif
+  //
+  // Record the drive encoders, the only encoders the program reads.
+  //
+  RplAddEncoder(g_Drive.motorLeft);
+  RplAddEncoder(g_Drive.motorRight);
   //
   // Initialize the Shoot subsystem.
   //
@@ -1207,9 +1241,39 @@ RobotInit()
               SHOOTER_POWER_STEP,
               SHOOTER_TIME_STEP);
   //
-  // Initialize the Autonomous state machine.
+  // Initialize the Autonomous state machine and subscribe it to the events
+  // its scripts wait for.
   //
   SMInit(g_AutoSM);
+  InitAutoScripts();
+  EvtBusInit(g_EvtBus);
+  EvtQueueInit(g_EvtQueue);
+  EvtBusSubscribe(g_EvtBus, SUBID_AUTO, EVTTYPE_DRIVE);
+  EvtBusSubscribe(g_EvtBus, SUBID_AUTO, EVTTYPE_SHOOTER);
+  //
+  // Initialize the scheduler and register the periodic tasks.
+  //
+  SchedInit(g_Sched, LOOP_PERIOD);
+  SchedAddTask(g_Sched, SCHEDTASK_BUTTON, BUTTON_PERIOD);
+  SchedAddTask(g_Sched, SCHEDTASK_DRIVE, DRIVE_PERIOD);
+  SchedAddTask(g_Sched, SCHEDTASK_SHOOTER, SHOOTER_PERIOD);
+  //
+  // Set up the display pages. The state is 0 in TeleOp mode.
+  //
+  DisplaySetLine(DISPPAGE_DRIVE, 0, "State=", DISPSLOT_STATE, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_DRIVE, 1, "Left=", DISPSLOT_ENCLEFT, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_DRIVE, 2, "Right=", DISPSLOT_ENCRIGHT, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_SHOOTER, 0, "Shooter=", DISPSLOT_SHOOTER, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_SHOOTER, 1, "Feeder=", DISPSLOT_FEEDER, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_SHOOTER, 2, "Roller=", DISPSLOT_ROLLER, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_SHOOTER, 3, "Elevator=", DISPSLOT_ELEVATOR, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_SCHED, 0, "Overruns=", DISPSLOT_OVERRUNS, DISPFMT_INT);
+  DisplaySetLine(DISPPAGE_SCHED, 1, "MaxLate=", DISPSLOT_MAXLATE, DISPFMT_INT);
+  for (int page = DISPPAGE_SHOOTER; page <= DISPPAGE_SCHED; ++page)
+  {
+    DisplaySetLine(page, 6, "Ext Batt:", DISPSLOT_EXTBATT, DISPFMT_VOLT);
+    DisplaySetLine(page, 7, "NXT Batt:", DISPSLOT_NXTBATT, DISPFMT_VOLT);
+  }
 
   TExit(INIT);
   return;
@@ -1230,16 +1294,24 @@ InputTasks(
   __in bool fDoJoystick
   )
 {
-  TFuncName("InputTasks");
+  TFuncId(FID_INPUTTASKS);
   TEnter(HIFREQ);
+  PrfEnter(PRFID_INPUT);
 
-  if (fDoJoystick)
+  //
+  // Each loop cycle is one frame of the input log, and a replayed cycle
+  // runs on the recorded cycle time.
+  //
+  RplFrameBegin(g_Sched.timeCycle);
+  if (fDoJoystick && SchedTaskDue(g_Sched, SCHEDTASK_BUTTON))
   {
     getJoystickSettings(joystick);
+    RplJoystick(joystick);
     ButtonTask(g_Buttons1);
     ButtonTask(g_Buttons2);
   }
 
+  PrfExit(PRFID_INPUT);
   TExit(HIFREQ);
   return;
 }   //InputTasks
@@ -1253,18 +1325,34 @@ InputTasks(
 void
 MainTasks()
 {
-  TFuncName("MainTasks");
+  TFuncId(FID_MAINTASKS);
   TEnter(HIFREQ);
+  PrfEnter(PRFID_MAIN);
+
+  //
+  // Update the telemetry slots. The display task will format and draw
+  // them at its own pace.
+  //
+  DisplaySetValue(DISPSLOT_STATE, g_AutoSM.currState);
+  DisplaySetValue(DISPSLOT_ENCLEFT, nMotorEncoder[g_Drive.motorLeft]);
+  DisplaySetValue(DISPSLOT_ENCRIGHT, nMotorEncoder[g_Drive.motorRight]);
+  DisplaySetValue(DISPSLOT_SHOOTER, g_Shooter.powerShooterCurr);
+  DisplaySetValue(DISPSLOT_FEEDER, g_Shooter.powerFeeder);
+  DisplaySetValue(DISPSLOT_ROLLER, g_Shooter.powerRoller);
+  DisplaySetValue(DISPSLOT_ELEVATOR, g_Shooter.powerElevator);
+  DisplaySetValue(DISPSLOT_OVERRUNS, g_Sched.cntOverruns);
+  DisplaySetValue(DISPSLOT_MAXLATE, g_Sched.timeMaxLate);
+  //
+  // The events posted by the input and output tasks are dispatched here,
+  // so the state machines only run in the main stage of the loop.
+  //
+  EvtQueueDrain(g_EvtQueue, g_EvtBus);
 
-  nxtDisplayTextLine(1, "Left=%d", nMotorEncoder[g_Drive.motorLeft]);
-  nxtDisplayTextLine(2, "Right=%d", nMotorEncoder[g_Drive.motorRight]);
   if (IsSMEnabled(g_AutoSM))
   {
     //
     // Autonomous mode.
     //
-    nxtDisplayTextLine(0, "Mode=Auto");
-    nxtDisplayTextLine(1, "State=%d", g_AutoSM.currState);
     AutonomousSM(g_AutoSM);
   }
   else if (!g_fCalDrive)
@@ -1276,12 +1364,10 @@ MainTasks()
     //
     // TeleOp mode.
     //
-    nxtDisplayTextLine(0, "Mode=TeleOp");
-//    nxtDisplayTextLine(1, "Left=%d", powerLeft);
-//    nxtDisplayTextLine(2, "Right=%d", powerRight);
     DriveTank(g_Drive, powerLeft, powerRight);
   }
 
+  PrfExit(PRFID_MAIN);
   TExit(HIFREQ);
   return;
 }   //MainTasks
@@ -1298,20 +1384,41 @@ MainTasks()
 void
 OutputTasks()
 {
-  TFuncName("OutputTasks");
+  TFuncId(FID_OUTPUTTASKS);
   TEnter(HIFREQ);
+  PrfEnter(PRFID_OUTPUT);
 
   //
   // The Drive task programs the drive motors and set the robot into
   // action.
   //
-  DriveTask(g_Drive);
+  if (SchedTaskDue(g_Sched, SCHEDTASK_DRIVE))
+  {
+    DriveTask(g_Drive);
+  }
   //
   // The Shooter task programs the shooter motors according to their
   // states.
   //
-  ShooterTask(g_Shooter);
+  if (SchedTaskDue(g_Sched, SCHEDTASK_SHOOTER))
+  {
+    ShooterTask(g_Shooter);
+  }
+  //
+  // If the events of the tasks above end the current step, start the next
+  // step now and let the drive program its motors in this cycle. An event
+  // of the second DriveTask waits for the next MainTasks, so this runs at
+  // most once per cycle.
+  //
+  if (AUTO_CHAIN && IsSMEnabled(g_AutoSM) &&
+      (EvtQueueDrain(g_EvtQueue, g_EvtBus) > 0) && IsSMReady(g_AutoSM))
+  {
+    AutonomousSM(g_AutoSM);
+    DriveTask(g_Drive);
+  }
+  RplFrameEnd();
 
+  PrfExit(PRFID_OUTPUT);
   TExit(HIFREQ);
   return;
 }   //OutputTasks
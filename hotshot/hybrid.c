@@ -40,11 +40,12 @@ task main()
   TraceInit(TRACE_MODULES, TRACE_LEVEL, MSG_LEVEL);
   DisplayInit();
   RobotInit();
+  SchedStart(g_Sched);
   while (true)
   {
     InputTasks(true);
     MainTasks();
     OutputTasks();
-    wait10Msec(1);
+    SchedWait(g_Sched);
   }
 }   //main
@@ -12,12 +12,47 @@
 /// </remarks>
 #endif
 
+//
+// MOD_SHOOTER is defined in hotshot.h ahead of the trace configuration.
+//
 #ifdef MOD_ID
   #undef MOD_ID
 #endif
-#define MOD_SHOOTER             TGenModId(1)
+#define FIDBASE_SHOOTER         TGenFidBase(1)
 #define MOD_ID                  MOD_SHOOTER
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_SHOOTERRESET        (FIDBASE_SHOOTER + 0)
+#define FID_SHOOTERINIT         (FIDBASE_SHOOTER + 1)
+#define FID_SHOOTERSETSHOOTPOWER (FIDBASE_SHOOTER + 2)
+#define FID_SHOOTERSETPICKUPPOWER (FIDBASE_SHOOTER + 3)
+#define FID_SHOOTERTASK         (FIDBASE_SHOOTER + 4)
+
+#ifdef _TRACE_FUNCNAMES
+string g_ShooterFuncNames[5] =
+{
+  "ShooterReset",
+  "ShooterInit",
+  "ShooterSetShootPower",
+  "ShooterSetPickupPower",
+  "ShooterTask"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_ShooterFuncNames
+
+//
+// End of generated function IDs.
+//
+
+#define PRFID_SHOOTER           PRFID_USER
+#define TSMPID_SHOOTER          TSMPID_USER
+
 //
 // Constants.
 //
@@ -28,6 +63,7 @@
 
 #define SHOOTEREVT_SHOOTSTOPPED  0
 #define SHOOTEREVT_PICKUPSTOPPED 1
+#define SHOOTEREVT_SPUNUP        2
 
 //
 // Type definitions.
@@ -76,7 +112,7 @@ ShooterReset(
   __out SHOOTER &shooter
   )
 {
-  TFuncName("ShooterReset");
+  TFuncId(FID_SHOOTERRESET);
   TEnter(FUNC);
 
   shooter.modeShooter = SHOOTERMODE_IDLE;
@@ -88,7 +124,7 @@ ShooterReset(
   shooter.event = 0;
   shooter.timeStopShooter = 0;
   shooter.timeStopPickup = 0;
-  shooter.timePrev = time1[T1];
+  shooter.timePrev = CtrlTime();
   motor[shooter.motorUpper] = 0;
   motor[shooter.motorLower] = 0;
   motor[shooter.motorFeeder] = 0;
@@ -142,7 +178,7 @@ ShooterInit(
   __in long timeStep
   )
 {
-  TFuncName("ShooterInit");
+  TFuncId(FID_SHOOTERINIT);
   TEnter(INIT);
 
   shooter.motorUpper = motorUpper;
@@ -185,14 +221,14 @@ ShooterSetShootPower(
   __in long timeDuration
   )
 {
-  TFuncName("ShooterSetShooter");
+  TFuncId(FID_SHOOTERSETSHOOTPOWER);
   TEnterMsg(API, ("Shoot=%d,Feed=%d", powerShooter, powerFeeder));
 
   shooter.powerShooterGoal = BOUND(powerShooter, 0, 100);
   shooter.powerFeeder = BOUND(powerFeeder, 0, 100);
   shooter.modeShooter = (powerShooter > shooter.powerShooterCurr)?
                         SHOOTERMODE_RAMPUP: SHOOTERMODE_RAMPDOWN;
-  shooter.timeStopShooter = (timeDuration > 0)? time1[T1] + timeDuration: 0;
+  shooter.timeStopShooter = (timeDuration > 0)? CtrlTime() + timeDuration: 0;
 
   TExit(API);
   return;
@@ -225,12 +261,12 @@ ShooterSetPickupPower(
   __in long timeDuration
   )
 {
-  TFuncName("ShooterSetPickup");
+  TFuncId(FID_SHOOTERSETPICKUPPOWER);
   TEnterMsg(API, ("Roller=%d,Elev=%d", powerRoller, powerElevator));
 
   shooter.powerRoller = BOUND(powerRoller, -100, 100);
   shooter.powerElevator = BOUND(powerElevator, -100, 100);
-  shooter.timeStopPickup = (timeDuration > 0)? time1[T1] + timeDuration: 0;
+  shooter.timeStopPickup = (timeDuration > 0)? CtrlTime() + timeDuration: 0;
 
   TExit(API);
   return;
@@ -251,10 +287,11 @@ ShooterTask(
   __inout SHOOTER &shooter
   )
 {
-  TFuncName("ShooterTask");
-  TEnter(HIFREQ);
+  TFuncId(FID_SHOOTERTASK);
+  TSampleEnter(HIFREQ, TSMPID_SHOOTER);
+  PrfEnter(PRFID_SHOOTER);
 
-  long timeCurr = time1[T1];
+  long timeCurr = CtrlTime();
 
   if (timeCurr >= shooter.timePrev + shooter.timeStep)
   {
@@ -295,6 +332,15 @@ ShooterTask(
         {
           shooter.powerShooterCurr += shooter.powerStep;
         }
+        if (shooter.powerShooterCurr >= shooter.powerShooterGoal)
+        {
+          //
+          // The shooter is up to speed.
+          //
+          shooter.modeShooter = SHOOTERMODE_IDLE;
+          shooter.event = SHOOTEREVT_SPUNUP;
+          ShooterEvent(shooter);
+        }
         break;
     }
     powerShooter = BOUND(shooter.powerShooterCurr, 0, 100);
@@ -306,6 +352,7 @@ ShooterTask(
     shooter.timePrev = timeCurr;
   }
 
-  TExit(HIFREQ);
+  PrfExit(PRFID_SHOOTER);
+  TSampleExit(HIFREQ);
   return;
 }   //ShooterTask
@@ -43,11 +43,12 @@ task main()
   //
   waitForStart();
   SMStop(g_AutoSM);
+  SchedStart(g_Sched);
   while (true)
   {
     InputTasks(true);
     MainTasks();
     OutputTasks();
-    wait10Msec(1);
+    SchedWait(g_Sched);
   }
 }   //main
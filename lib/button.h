@@ -24,6 +24,29 @@
 #endif
 #define MOD_ID                  MOD_BUTTON
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_BUTTONINIT          (FIDBASE_BUTTON + 0)
+#define FID_BUTTONTASK          (FIDBASE_BUTTON + 1)
+
+#ifdef _TRACE_FUNCNAMES
+string g_ButtonFuncNames[2] =
+{
+  "ButtonInit",
+  "ButtonTask"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_ButtonFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Constants.
 //
@@ -105,7 +128,7 @@ ButtonInit(
   __in int flagsButton
   )
 {
-  TFuncName("ButtonInit");
+  TFuncId(FID_BUTTONINIT);
   TEnter(INIT);
 
   button.idJoystick = idJoystick;
@@ -137,8 +160,9 @@ ButtonTask(
   int currButtons = (button.idJoystick == 1)? joystick.joy1_Buttons:
                                               joystick.joy2_Buttons;
 
-  TFuncName("ButtonTask");
-  TEnterMsg(HIFREQ, ("Prev=%x,Curr=%x", button.prevButtons, currButtons));
+  TFuncId(FID_BUTTONTASK);
+  TSampleEnterMsg(HIFREQ, TSMPID_BUTTON, ("Prev=%x,Curr=%x", button.prevButtons, currButtons));
+  PrfEnter(PRFID_BUTTON);
 
   if (button.flagsButton & BTNF_ENABLE_EVENTS)
   {
@@ -171,7 +195,8 @@ ButtonTask(
   }
   button.prevButtons = currButtons;
 
-  TExit(HIFREQ);
+  PrfExit(PRFID_BUTTON);
+  TSampleExit(HIFREQ);
   return;
 }   //ButtonTask
 
@@ -24,6 +24,12 @@
 
 #define ARRAYSIZE(a)            (sizeof(a)/sizeof(a[0]))
 
+//
+// The time the control code runs on. It is nPgmTime unless the input
+// recorder (replay.h) runs the control code on the time of its frames.
+//
+#define CtrlTime()              nPgmTime
+
 //
 // The BOUND macro limits the value (n) within the bounds between the given
 // low (l) and high (h).
@@ -9,35 +9,240 @@
 ///
 /// <remarks>
 ///   Environment: RobotC for Lego Mindstorms NXT.
+///   The control code only writes raw integer values into telemetry slots.
+///   All the text formatting is done by the low priority DisplayTask which
+///   redraws only the lines whose values have changed.
+///   DisplayHold stops the redraws while the program uses the LCD by
+///   itself, e.g. for a menu before the match starts.
 /// </remarks>
 #endif
 
 #ifndef _DISPLAY_H
 #define _DISPLAY_H
 
-task DisplayTask()
+//
+// Constants.
+//
+#define DISP_NUM_LINES          8
+#ifndef MAX_DISP_PAGES
+  #define MAX_DISP_PAGES        3
+#endif
+#ifndef MAX_DISP_SLOTS
+  #define MAX_DISP_SLOTS        16
+#endif
+#ifndef DISPLAY_INTERVAL
+  #define DISPLAY_INTERVAL      200     //in msec
+#endif
+
+#define DISPSLOT_EXTBATT        0
+#define DISPSLOT_NXTBATT        1
+#define DISPSLOT_USER           2
+
+#define DISPFMT_NONE            0
+#define DISPFMT_INT             1       //label followed by the value
+#define DISPFMT_VOLT            2       //value in mV shown as x.x V
+
+//
+// Macros.
+//
+#define DisplaySetValue(s,v)    g_Display.Values[s] = (v)
+
+//
+// Type definitions.
+//
+typedef struct
 {
-  while (true)
+  string label;
+  int    idSlot;
+  int    fmtLine;
+  int    valueShown;
+} DISP_LINE;
+
+typedef struct
+{
+  int       Values[MAX_DISP_SLOTS];
+  DISP_LINE Lines[MAX_DISP_PAGES*DISP_NUM_LINES];
+  int       numPages;
+  int       currPage;
+  int       pageShown;
+  bool      fHold;
+} DISPLAY;
+
+//
+// Global data.
+//
+DISPLAY g_Display;
+
+/// <summary>
+///   This function binds a display line of a page to a telemetry slot.
+/// </summary>
+///
+/// <param name="page">
+///   Specifies the display page.
+/// </param>
+/// <param name="line">
+///   Specifies the line number on the page.
+/// </param>
+/// <param name="label">
+///   Specifies the label printed in front of the value.
+/// </param>
+/// <param name="idSlot">
+///   Specifies the telemetry slot to be displayed.
+/// </param>
+/// <param name="fmtLine">
+///   Specifies the DISPFMT format of the value.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DisplaySetLine(
+  __in int page,
+  __in int line,
+  __in string label,
+  __in int idSlot,
+  __in int fmtLine
+  )
+{
+  if ((page >= 0) && (page < MAX_DISP_PAGES) &&
+      (line >= 0) && (line < DISP_NUM_LINES) &&
+      (idSlot >= 0) && (idSlot < MAX_DISP_SLOTS))
+  {
+    int i = page*DISP_NUM_LINES + line;
+
+    g_Display.Lines[i].label = label;
+    g_Display.Lines[i].idSlot = idSlot;
+    g_Display.Lines[i].fmtLine = fmtLine;
+    if (page >= g_Display.numPages)
+    {
+      g_Display.numPages = page + 1;
+    }
+    //
+    // Force the line to be redrawn if it is on the current page.
+    //
+    if (page == g_Display.currPage)
+    {
+      g_Display.pageShown = -1;
+    }
+  }
+
+  return;
+}   //DisplaySetLine
+
+/// <summary>
+///   This function switches the display to the next page.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+DisplayNextPage()
+{
+  g_Display.currPage = (g_Display.currPage + 1)%g_Display.numPages;
+  return;
+}   //DisplayNextPage
+
+/// <summary>
+///   This function redraws the lines of the current page that have changed
+///   since they were last drawn. All lines are redrawn if the page has
+///   changed.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+DisplayRefresh()
+{
+  int page = g_Display.currPage;
+  bool fRedraw = (page != g_Display.pageShown);
+
+  if (fRedraw && (g_Display.pageShown >= 0))
+  {
+    eraseDisplay();
+  }
+  g_Display.pageShown = page;
+
+  for (int line = 0; line < DISP_NUM_LINES; ++line)
   {
-    if (externalBatteryAvg < 0)
+    int i = page*DISP_NUM_LINES + line;
+    int value = g_Display.Values[g_Display.Lines[i].idSlot];
+
+    if ((g_Display.Lines[i].fmtLine != DISPFMT_NONE) &&
+        (fRedraw || (value != g_Display.Lines[i].valueShown)))
     {
-      //
-      // External battery is off or not connected.
-      //
-      nxtDisplayTextLine(6, "Ext Batt:OFF");
+      g_Display.Lines[i].valueShown = value;
+      switch (g_Display.Lines[i].fmtLine)
+      {
+        case DISPFMT_INT:
+          nxtDisplayTextLine(line, "%s%d", g_Display.Lines[i].label, value);
+          break;
+
+        case DISPFMT_VOLT:
+          if (value < 0)
+          {
+            //
+            // Battery is off or not connected.
+            //
+            nxtDisplayTextLine(line, "%sOFF", g_Display.Lines[i].label);
+          }
+          else
+          {
+            nxtDisplayTextLine(line, "%s%d.%d V",
+                               g_Display.Lines[i].label,
+                               value/1000, (value%1000)/100);
+          }
+          break;
+      }
     }
-    else
+  }
+
+  return;
+}   //DisplayRefresh
+
+/// <summary>
+///   This function stops or resumes the redraws of the display task. The
+///   current page is redrawn in full when the display is released.
+/// </summary>
+///
+/// <param name="fHold">
+///   Specifies true to stop the redraws, false to resume them.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DisplayHold(
+  __in bool fHold
+  )
+{
+  g_Display.fHold = fHold;
+  if (!fHold)
+  {
+    eraseDisplay();
+    g_Display.pageShown = -1;
+  }
+
+  return;
+}   //DisplayHold
+
+task DisplayTask()
+{
+  nSchedulePriority = kLowPriority;
+  while (true)
+  {
+    DisplaySetValue(DISPSLOT_EXTBATT, externalBatteryAvg);
+    DisplaySetValue(DISPSLOT_NXTBATT, nAvgBatteryLevel);
+    if (!g_Display.fHold)
     {
-      nxtDisplayTextLine(6, "Ext Batt:%4.1f V",
-                         (float)externalBatteryAvg/1000.0);
+      DisplayRefresh();
     }
-    nxtDisplayTextLine(7, "NXT Batt:%4.1f V", (float)nAvgBatteryLevel/1000.0);
-    wait1Msec(200);
+    wait1Msec(DISPLAY_INTERVAL);
   }
 }   //DisplayTask
 
 /// <summary>
-///   This function initializes the NXT LCD display.
+///   This function initializes the NXT LCD display. By default, page 0
+///   shows the external and NXT battery levels on the last two lines.
 /// </summary>
 ///
 /// <returns> None. </returns>
@@ -45,6 +250,25 @@ task DisplayTask()
 void
 DisplayInit()
 {
+  for (int i = 0; i < MAX_DISP_SLOTS; ++i)
+  {
+    g_Display.Values[i] = 0;
+  }
+
+  for (int i = 0; i < MAX_DISP_PAGES*DISP_NUM_LINES; ++i)
+  {
+    g_Display.Lines[i].label = "";
+    g_Display.Lines[i].idSlot = 0;
+    g_Display.Lines[i].fmtLine = DISPFMT_NONE;
+    g_Display.Lines[i].valueShown = 0;
+  }
+  g_Display.numPages = 1;
+  g_Display.currPage = 0;
+  g_Display.pageShown = -1;
+  g_Display.fHold = false;
+  DisplaySetLine(0, 6, "Ext Batt:", DISPSLOT_EXTBATT, DISPFMT_VOLT);
+  DisplaySetLine(0, 7, "NXT Batt:", DISPSLOT_NXTBATT, DISPFMT_VOLT);
+
   StopTask(displayDiagnostics);
   eraseDisplay();
   StartTask(DisplayTask);
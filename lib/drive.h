@@ -9,6 +9,10 @@
 ///
 /// <remarks>
 ///   Environment: RobotC for Lego Mindstorms NXT.
+///   The PID drive modes can follow a trapezoidal motion profile with
+///   feed-forward, end on a settle tolerance and hold the heading with a
+///   HiTechnic gyro. DRIVEF_FIXED_PID runs the PID in fixed point, which
+///   sim/pidbench.cpp checks against the float PID.
 /// </remarks>
 #endif
 
@@ -22,6 +26,51 @@
 #endif
 #define MOD_ID                  MOD_DRIVE
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_DRIVESTOP           (FIDBASE_DRIVE + 0)
+#define FID_DRIVERESET          (FIDBASE_DRIVE + 1)
+#define FID_DRIVEINIT           (FIDBASE_DRIVE + 2)
+#define FID_DRIVETANK           (FIDBASE_DRIVE + 3)
+#define FID_DRIVEARCADE         (FIDBASE_DRIVE + 4)
+#define FID_DRIVESETPROFILE     (FIDBASE_DRIVE + 5)
+#define FID_DRIVEPROFILESTART   (FIDBASE_DRIVE + 6)
+#define FID_DRIVESETTOLERANCE   (FIDBASE_DRIVE + 7)
+#define FID_DRIVESETFEEDFORWARD (FIDBASE_DRIVE + 8)
+#define FID_DRIVESETGYRO        (FIDBASE_DRIVE + 9)
+#define FID_DRIVEPIDSETDISTANCE (FIDBASE_DRIVE + 10)
+#define FID_DRIVEPIDSETANGLE    (FIDBASE_DRIVE + 11)
+#define FID_DRIVETASK           (FIDBASE_DRIVE + 12)
+
+#ifdef _TRACE_FUNCNAMES
+string g_DriveFuncNames[13] =
+{
+  "DriveStop",
+  "DriveReset",
+  "DriveInit",
+  "DriveTank",
+  "DriveArcade",
+  "DriveSetProfile",
+  "DriveProfileStart",
+  "DriveSetTolerance",
+  "DriveSetFeedForward",
+  "DriveSetGyro",
+  "DrivePIDSetDistance",
+  "DrivePIDSetAngle",
+  "DriveTask"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_DriveFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Constants.
 //
@@ -32,6 +81,14 @@
 
 #define DRIVEF_USER_MASK        0x00ff
 #define DRIVEF_ENABLE_EVENTS    0x0001
+#define DRIVEF_FIXED_PID        0x0002
+
+#ifndef DRIVE_VEL_FILTER
+  #define DRIVE_VEL_FILTER      2       //a new sample has 1/2 the weight
+#endif
+#ifndef DRIVE_FIXED_SHIFT
+  #define DRIVE_FIXED_SHIFT     16      //fraction bits of the fixed PID gains
+#endif
 
 //
 // Macros.
@@ -40,6 +97,13 @@
 #define IsRunning(d)            (IsRunningState(nMotorRunState[d.motorLeft]) || \
                                  IsRunningState(nMotorRunState[d.motorRight]))
 #define NORMALIZE_POWER(n,m)    NORMALIZE(n, -100, 100, -(m), (m))
+#define DRIVE_FIXED(f)          (long)((f)*(1L << DRIVE_FIXED_SHIFT) + \
+                                       (((f) < 0.0)? -0.5: 0.5))
+//
+// Truncates toward zero like the float to int conversion of the float PID.
+//
+#define DRIVE_FIXED_INT(n)      (((n) < 0)? -(-(n) >> DRIVE_FIXED_SHIFT): \
+                                            ((n) >> DRIVE_FIXED_SHIFT))
 
 //
 // Type definitions.
@@ -53,6 +117,9 @@ typedef struct
   float Kp;
   float Ki;
   float Kd;
+  long  KpFixed;                //in Q DRIVE_FIXED_SHIFT
+  long  KiFixed;
+  long  KdFixed;
   int   flagsDrive;
   int   modeDrive;
   int   powerLeft;
@@ -63,6 +130,46 @@ typedef struct
   int   errRightPrev;
   int   errLeftIntegral;
   int   errRightIntegral;
+  float velMax;                 //in clicks/msec, 0 if no profile
+  float accMax;                 //in clicks/msec^2
+  bool  fProfile;
+  long  profTimeStart;
+  float profDist;               //in clicks
+  float profVel;                //in clicks/msec
+  float profTimeAcc;            //in msec
+  float profTimeTotal;          //in msec
+  long  profTimeAccFixed;       //in msec, for the fixed point PID
+  long  profTimeTotalFixed;     //in msec
+  long  accFixed;               //in clicks/msec^2, Q DRIVE_FIXED_SHIFT
+  long  profVelFixed;           //in clicks/msec, Q DRIVE_FIXED_SHIFT
+  long  ffAccFixed;             //kV times accMax, Q DRIVE_FIXED_SHIFT
+  long  ffBiasFixed;            //kA times accMax, Q DRIVE_FIXED_SHIFT
+  long  ffCruiseFixed;          //kV times profVel, Q DRIVE_FIXED_SHIFT
+  int   clickStartLeft;
+  int   clickStartRight;
+  int   clickTolDistance;       //in clicks, 0 if no tolerance
+  int   clickTolAngle;          //in clicks
+  int   velTolerance;           //in clicks/sec
+  int   timeSettle;             //in msec
+  int   timeMax;                //in msec, 0 if no limit
+  int   clickTolerance;         //of the current move
+  long  timeStart;
+  long  timeSettleStart;        //-1 if not on target
+  bool  fOnTarget;              //last move ended, not timed out
+  long  timePrev;               //of the last velocity sample
+  int   clickPrevLeft;
+  int   clickPrevRight;
+  int   velLeft;                //in clicks/sec, filtered
+  int   velRight;
+  float kV;                     //in power per clicks/msec
+  float kA;                     //in power per clicks/msec^2
+#ifdef __HTGYRO_H__
+  int   idGyro;                 //-1 if no heading hold
+  long  timeGyroPrev;
+  long  headingGyro;            //in millidegrees, + is right
+  long  headingTarget;          //in millidegrees
+  long  clickTurnStart;         //left minus right target at the start
+#endif
 } DRIVE;
 
 //
@@ -88,12 +195,13 @@ DriveStop(
   __out DRIVE &drive
   )
 {
-  TFuncName("DriveStop");
+  TFuncId(FID_DRIVESTOP);
   TEnter(API);
 
   drive.modeDrive = DRIVEMODE_STOPPED;
   drive.powerLeft = 0;
   drive.powerRight = 0;
+  drive.fOnTarget = false;
   //
   // Stop the motors.
   //
@@ -119,7 +227,7 @@ DriveReset(
   __out DRIVE &drive
   )
 {
-  TFuncName("DriveReset");
+  TFuncId(FID_DRIVERESET);
   TEnter(API);
 
   DriveStop(drive);
@@ -134,6 +242,17 @@ DriveReset(
   drive.errRightPrev = 0;
   drive.errLeftIntegral = 0;
   drive.errRightIntegral = 0;
+  drive.timePrev = CtrlTime();
+  drive.clickPrevLeft = 0;
+  drive.clickPrevRight = 0;
+  drive.velLeft = 0;
+  drive.velRight = 0;
+#ifdef __HTGYRO_H__
+  drive.timeGyroPrev = CtrlTime();
+  drive.headingGyro = 0;
+  drive.headingTarget = 0;
+  drive.clickTurnStart = 0;
+#endif
 
   TExit(API);
   return;
@@ -169,7 +288,9 @@ DriveReset(
 ///   Specifies the differential constant for PID drive.
 /// </param>
 /// <param name="flagsDrive">
-///   Specifies the drive flags.
+///   Specifies the drive flags. With DRIVEF_FIXED_PID, the gains are
+///   converted to Q16 and the PID power before the power limit must stay
+///   in the int range, for example Kp up to 3 for errors up to 8000 clicks.
 /// </param>
 ///
 /// <returns> None. </returns>
@@ -187,17 +308,34 @@ DriveInit(
   __in int flagsDrive
   )
 {
-  TFuncName("DriveInit");
+  TFuncId(FID_DRIVEINIT);
   TEnter(INIT);
 
   drive.motorLeft = motorLeft;
   drive.motorRight = motorRight;
   drive.clicksPerDistance = clicksPerDistance;
   drive.clicksPerDegree = clicksPerDegree;
-  drive.Kp = Kp;
-  drive.Ki = Ki;
-  drive.Kd = Kd;
+  drive.KpFixed = DRIVE_FIXED(Kp);
+  drive.KiFixed = DRIVE_FIXED(Ki);
+  drive.KdFixed = DRIVE_FIXED(Kd);
+  drive.Kp = (float)drive.KpFixed/(1L << DRIVE_FIXED_SHIFT);
+  drive.Ki = (float)drive.KiFixed/(1L << DRIVE_FIXED_SHIFT);
+  drive.Kd = (float)drive.KdFixed/(1L << DRIVE_FIXED_SHIFT);
   drive.flagsDrive = flagsDrive & DRIVEF_USER_MASK;
+  drive.velMax = 0.0;
+  drive.accMax = 0.0;
+  drive.fProfile = false;
+  drive.clickTolDistance = 0;
+  drive.clickTolAngle = 0;
+  drive.velTolerance = 0;
+  drive.timeSettle = 0;
+  drive.timeMax = 0;
+  drive.clickTolerance = 0;
+  drive.kV = 0.0;
+  drive.kA = 0.0;
+#ifdef __HTGYRO_H__
+  drive.idGyro = -1;
+#endif
   DriveReset(drive);
 
   TExit(INIT);
@@ -227,12 +365,13 @@ DriveTank(
   __in int powerRight
   )
 {
-  TFuncName("DriveTank");
+  TFuncId(FID_DRIVETANK);
   TEnterMsg(HIFREQ, ("Left=%d,Right=%d", powerLeft, powerRight));
 
   drive.powerLeft = BOUND(powerLeft, -100, 100);
   drive.powerRight = BOUND(powerRight, -100, 100);
   drive.modeDrive = DRIVEMODE_DRIVE;
+  drive.fOnTarget = false;
 
   TExit(HIFREQ);
   return;
@@ -261,7 +400,7 @@ DriveArcade(
   __in int powerTurn
   )
 {
-  TFuncName("DriveArcade");
+  TFuncId(FID_DRIVEARCADE);
   TEnterMsg(HIFREQ, ("Drive=%d,Turn=%d", powerDrive, powerTurn));
 
   powerDrive = BOUND(powerDrive, -100, 100);
@@ -312,11 +451,558 @@ DriveArcade(
     drive.powerRight = powerDrive - powerTurn;
   }
   drive.modeDrive = DRIVEMODE_DRIVE;
+  drive.fOnTarget = false;
 
   TExit(HIFREQ);
   return;
 }   //DriveArcade
 
+/// <summary>
+///   This function sets the motion profile limits of the PID drive modes.
+///   The limits apply to the travel of each wheel, so they are the same for
+///   driving and turning. The power of a PID move is still the motor power
+///   limit, and it also sets the cruise velocity as a percentage of the
+///   velocity limit.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="velMax">
+///   Specifies the velocity limit in distance units per second, 0 to turn
+///   off the motion profile.
+/// </param>
+/// <param name="accMax">
+///   Specifies the acceleration limit in distance units per second squared.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveSetProfile(
+  __out DRIVE &drive,
+  __in float velMax,
+  __in float accMax
+  )
+{
+  TFuncId(FID_DRIVESETPROFILE);
+  TEnterMsg(API, ("V=%5.1f,A=%5.1f", TFloat(velMax, 1), TFloat(accMax, 1)));
+
+  if ((velMax > 0.0) && (accMax > 0.0))
+  {
+    drive.velMax = velMax*drive.clicksPerDistance/1000.0;
+    drive.accMax = accMax*drive.clicksPerDistance/1000000.0;
+  }
+  else
+  {
+    drive.velMax = 0.0;
+    drive.accMax = 0.0;
+  }
+
+  TExit(API);
+  return;
+}   //DriveSetProfile
+
+/// <summary>
+///   This function starts the motion profile of a PID drive mode if the
+///   profile is turned on. The profile accelerates to the cruise velocity,
+///   cruises and decelerates to the target. A short move that can't reach
+///   the cruise velocity becomes a triangle.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="clicksTarget">
+///   Specifies the clicks each wheel has to travel.
+/// </param>
+/// <param name="power">
+///   Specifies the power limit of the move, which is also the percentage of
+///   the velocity limit to cruise at.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveProfileStart(
+  __inout DRIVE &drive,
+  __in int clicksTarget,
+  __in int power
+  )
+{
+  TFuncId(FID_DRIVEPROFILESTART);
+  TEnterMsg(FUNC, ("Clicks=%d,Pwr=%d", clicksTarget, power));
+
+  drive.fProfile = (drive.velMax > 0.0) && (power > 0) && (clicksTarget != 0);
+  if (drive.fProfile)
+  {
+    drive.profTimeStart = CtrlTime();
+    drive.profDist = abs(clicksTarget);
+    drive.profVel = drive.velMax*power/100.0;
+    drive.profTimeAcc = drive.profVel/drive.accMax;
+    if (drive.profVel*drive.profTimeAcc > drive.profDist)
+    {
+      drive.profTimeAcc = sqrt(drive.profDist/drive.accMax);
+      drive.profVel = drive.accMax*drive.profTimeAcc;
+    }
+    drive.profTimeTotal = drive.profTimeAcc + drive.profDist/drive.profVel;
+    if (drive.flagsDrive & DRIVEF_FIXED_PID)
+    {
+      //
+      // The fixed point PID follows the profile on whole msec.
+      //
+      drive.profTimeAccFixed = (long)(drive.profTimeAcc + 0.5);
+      drive.profTimeTotalFixed = (long)(drive.profTimeTotal + 0.5);
+      drive.accFixed = DRIVE_FIXED(drive.accMax);
+      drive.profVelFixed = DRIVE_FIXED(drive.profVel);
+      drive.ffAccFixed = DRIVE_FIXED(drive.kV*drive.accMax);
+      drive.ffBiasFixed = DRIVE_FIXED(drive.kA*drive.accMax);
+      drive.ffCruiseFixed = DRIVE_FIXED(drive.kV*drive.profVel);
+    }
+    drive.clickStartLeft = nMotorEncoder[drive.motorLeft];
+    drive.clickStartRight = nMotorEncoder[drive.motorRight];
+    drive.errLeftPrev = 0;
+    drive.errRightPrev = 0;
+  }
+
+  TExitMsg(FUNC, ("Time=%d", (int)drive.profTimeTotal));
+  return;
+}   //DriveProfileStart
+
+/// <summary>
+///   This function returns how far along the motion profile the target is.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="time">
+///   Specifies the time since the start of the profile in msec.
+/// </param>
+///
+/// <returns> Returns the fraction of the travel from 0.0 to 1.0. </returns>
+
+float
+DriveProfileFraction(
+  __in DRIVE &drive,
+  __in long time
+  )
+{
+  float t = time;
+  float dist;
+
+  if (t >= drive.profTimeTotal)
+  {
+    dist = drive.profDist;
+  }
+  else if (t < drive.profTimeAcc)
+  {
+    dist = drive.accMax*t*t/2.0;
+  }
+  else if (t < drive.profTimeTotal - drive.profTimeAcc)
+  {
+    dist = drive.profVel*(t - drive.profTimeAcc/2.0);
+  }
+  else
+  {
+    t = drive.profTimeTotal - t;
+    dist = drive.profDist - drive.accMax*t*t/2.0;
+  }
+
+  return dist/drive.profDist;
+}   //DriveProfileFraction
+
+/// <summary>
+///   This function returns how far along the motion profile the target is
+///   for the fixed point PID.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="time">
+///   Specifies the time since the start of the profile in msec.
+/// </param>
+///
+/// <returns> Returns the fraction of the travel in Q DRIVE_FIXED_SHIFT.
+/// </returns>
+
+long
+DriveProfileFractionFixed(
+  __in DRIVE &drive,
+  __in long time
+  )
+{
+  long dist;
+
+  if (time >= drive.profTimeTotalFixed)
+  {
+    return 1L << DRIVE_FIXED_SHIFT;
+  }
+  else if (time < drive.profTimeAccFixed)
+  {
+    dist = drive.accFixed*time/2*time;
+  }
+  else if (time < drive.profTimeTotalFixed - drive.profTimeAccFixed)
+  {
+    dist = drive.profVelFixed/2*(2*time - drive.profTimeAccFixed);
+  }
+  else
+  {
+    time = drive.profTimeTotalFixed - time;
+    dist = ((long)drive.profDist << DRIVE_FIXED_SHIFT) -
+           drive.accFixed*time/2*time;
+  }
+
+  return dist/(long)drive.profDist;
+}   //DriveProfileFractionFixed
+
+/// <summary>
+///   This function sets the completion criteria of the PID drive moves
+///   that follow. A move is done when both wheels are within the position
+///   tolerance of the final target and slower than the velocity threshold
+///   for the settle time, even if its motion profile hasn't ended yet, or
+///   when the maximum duration has passed. The PID power no longer ends the
+///   move, so a move that can't get within the tolerance runs until the
+///   maximum duration or until it is stopped.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="tolDistance">
+///   Specifies the position tolerance of PID_DISTANCE moves in distance
+///   units, 0 to turn off the tolerance.
+/// </param>
+/// <param name="tolAngle">
+///   Specifies the position tolerance of PID_ANGLE moves in degrees, 0 to
+///   turn off the tolerance.
+/// </param>
+/// <param name="velTolerance">
+///   Specifies the velocity threshold of the wheels in distance units per
+///   second.
+/// </param>
+/// <param name="timeSettle">
+///   Specifies the time the robot must stay on target in msec.
+/// </param>
+/// <param name="timeMax">
+///   Specifies the maximum duration of a move in msec, 0 if no limit.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveSetTolerance(
+  __out DRIVE &drive,
+  __in float tolDistance,
+  __in float tolAngle,
+  __in float velTolerance,
+  __in int timeSettle,
+  __in int timeMax
+  )
+{
+  TFuncId(FID_DRIVESETTOLERANCE);
+  TEnterMsg(API, ("D=%5.2f,A=%5.2f",
+                  TFloat(tolDistance, 2), TFloat(tolAngle, 2)));
+
+  drive.clickTolDistance = (int)(tolDistance*drive.clicksPerDistance);
+  drive.clickTolAngle = (int)(tolAngle*drive.clicksPerDegree);
+  drive.velTolerance = (int)(velTolerance*drive.clicksPerDistance);
+  drive.timeSettle = timeSettle;
+  drive.timeMax = timeMax;
+
+  TExit(API);
+  return;
+}   //DriveSetTolerance
+
+/// <summary>
+///   This function sets the feed-forward gains of the PID drive modes with
+///   a motion profile.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="kV">
+///   Specifies the power per distance unit per second of wheel velocity.
+/// </param>
+/// <param name="kA">
+///   Specifies the power per distance unit per second squared of wheel
+///   acceleration.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveSetFeedForward(
+  __out DRIVE &drive,
+  __in float kV,
+  __in float kA
+  )
+{
+  TFuncId(FID_DRIVESETFEEDFORWARD);
+  TEnterMsg(API, ("kV=%5.2f,kA=%5.2f", TFloat(kV, 2), TFloat(kA, 2)));
+
+  drive.kV = kV*1000.0/drive.clicksPerDistance;
+  drive.kA = kA*1000000.0/drive.clicksPerDistance;
+
+  TExit(API);
+  return;
+}   //DriveSetFeedForward
+
+#ifdef __HTGYRO_H__
+/// <summary>
+///   This function sets the gyro of the heading hold of PID_DISTANCE. The
+///   gyro must be calibrated and mounted so that a right turn reads
+///   positive. The set points of the wheels are then steered apart by the
+///   heading error the encoders don't see, and the target heading carries
+///   over the moves like the targets of the wheels.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="idGyro">
+///   Specifies the sensor port of the gyro, -1 to turn off the heading
+///   hold.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveSetGyro(
+  __out DRIVE &drive,
+  __in int idGyro
+  )
+{
+  TFuncId(FID_DRIVESETGYRO);
+  TEnterMsg(API, ("Gyro=%d", idGyro));
+
+  drive.idGyro = idGyro;
+  drive.timeGyroPrev = CtrlTime();
+
+  TExit(API);
+  return;
+}   //DriveSetGyro
+
+/// <summary>
+///   This function returns the heading of the robot integrated from the
+///   gyro.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+///
+/// <returns> Returns the heading in degrees, + is right. </returns>
+
+float
+DriveGetHeading(
+  __in DRIVE &drive
+  )
+{
+  return drive.headingGyro/1000.0;
+}   //DriveGetHeading
+
+/// <summary>
+///   This function integrates the turn rate of the gyro since the last
+///   sample into the heading. A second call in the same msec is skipped.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="timeNow">
+///   Specifies the current time in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveUpdateHeading(
+  __inout DRIVE &drive,
+  __in long timeNow
+  )
+{
+  long timeDelta = timeNow - drive.timeGyroPrev;
+  int rate;
+
+  if ((drive.idGyro >= 0) && (timeDelta > 0))
+  {
+    rate = HTGYROreadRot((tSensors)drive.idGyro);
+    RplSensor(rate);
+    drive.headingGyro += (long)rate*timeDelta;
+    drive.timeGyroPrev = timeNow;
+  }
+
+  return;
+}   //DriveUpdateHeading
+#endif
+
+/// <summary>
+///   This function returns the velocity of the robot.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+///
+/// <returns> Returns the velocity in distance units per second. </returns>
+
+float
+DriveGetVelocity(
+  __in DRIVE &drive
+  )
+{
+  return (drive.velLeft + drive.velRight)/2.0/drive.clicksPerDistance;
+}   //DriveGetVelocity
+
+/// <summary>
+///   This function returns the turn rate of the robot.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+///
+/// <returns> Returns the turn rate in degrees per second, + is right.
+///           </returns>
+
+float
+DriveGetTurnRate(
+  __in DRIVE &drive
+  )
+{
+  return (drive.velLeft - drive.velRight)/2.0/drive.clicksPerDegree;
+}   //DriveGetTurnRate
+
+/// <summary>
+///   This function updates the velocity of the wheels with the encoder
+///   deltas since the last sample. A second call in the same msec is
+///   skipped.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="timeNow">
+///   Specifies the current time in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveUpdateVelocity(
+  __inout DRIVE &drive,
+  __in long timeNow
+  )
+{
+  long timeDelta = timeNow - drive.timePrev;
+  int clickLeft = nMotorEncoder[drive.motorLeft];
+  int clickRight = nMotorEncoder[drive.motorRight];
+
+  if (timeDelta > 0)
+  {
+    drive.velLeft += ((long)(clickLeft - drive.clickPrevLeft)*1000/timeDelta -
+                      drive.velLeft)/DRIVE_VEL_FILTER;
+    drive.velRight += ((long)(clickRight - drive.clickPrevRight)*1000/timeDelta -
+                       drive.velRight)/DRIVE_VEL_FILTER;
+    drive.timePrev = timeNow;
+    drive.clickPrevLeft = clickLeft;
+    drive.clickPrevRight = clickRight;
+  }
+
+  return;
+}   //DriveUpdateVelocity
+
+/// <summary>
+///   This function returns the feed-forward power of the motion profile
+///   for a wheel that travels the whole profile distance forward.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="time">
+///   Specifies the time since the start of the profile in msec.
+/// </param>
+///
+/// <returns> Returns the feed-forward power. </returns>
+
+float
+DriveProfileFeedForward(
+  __in DRIVE &drive,
+  __in long time
+  )
+{
+  float t = time;
+  float power = 0.0;
+
+  if (t >= drive.profTimeTotal)
+  {
+    power = 0.0;
+  }
+  else if (t < drive.profTimeAcc)
+  {
+    power = drive.kV*drive.accMax*t + drive.kA*drive.accMax;
+  }
+  else if (t < drive.profTimeTotal - drive.profTimeAcc)
+  {
+    power = drive.kV*drive.profVel;
+  }
+  else
+  {
+    power = drive.kV*drive.accMax*(drive.profTimeTotal - t) -
+            drive.kA*drive.accMax;
+  }
+
+  return power;
+}   //DriveProfileFeedForward
+
+/// <summary>
+///   This function returns the feed-forward power of the motion profile
+///   for the fixed point PID.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="time">
+///   Specifies the time since the start of the profile in msec.
+/// </param>
+///
+/// <returns> Returns the feed-forward power in Q DRIVE_FIXED_SHIFT.
+/// </returns>
+
+long
+DriveProfileFeedForwardFixed(
+  __in DRIVE &drive,
+  __in long time
+  )
+{
+  long power;
+
+  if (time >= drive.profTimeTotalFixed)
+  {
+    power = 0;
+  }
+  else if (time < drive.profTimeAccFixed)
+  {
+    power = drive.ffAccFixed*time + drive.ffBiasFixed;
+  }
+  else if (time < drive.profTimeTotalFixed - drive.profTimeAccFixed)
+  {
+    power = drive.ffCruiseFixed;
+  }
+  else
+  {
+    power = drive.ffAccFixed*(drive.profTimeTotalFixed - time) -
+            drive.ffBiasFixed;
+  }
+
+  return power;
+}   //DriveProfileFeedForwardFixed
+
 /// <summary>
 ///   This function sets PID_DISTANCE drive mode with the given drive distance
 ///   set point.
@@ -341,20 +1027,40 @@ DrivePIDSetDistance(
   __in int powerDrive
   )
 {
-  TFuncName("DrivePIDSetDistance");
-  TEnterMsg(API, ("D=%5.1f,Pwr=%d", setptDistance, powerDrive));
+  TFuncId(FID_DRIVEPIDSETDISTANCE);
+  TEnterMsg(API, ("D=%5.1f,Pwr=%d", TFloat(setptDistance, 1), powerDrive));
 
   int clicksTarget = (int)(setptDistance*drive.clicksPerDistance);
 
   powerDrive = BOUND(abs(powerDrive), 0, 100);
   drive.powerLeft = powerDrive;
   drive.powerRight = powerDrive;
-  drive.clickTargetLeft = nMotorEncoder[drive.motorLeft] + clicksTarget;
-  drive.clickTargetRight = nMotorEncoder[drive.motorRight] + clicksTarget;
+  //
+  // A move that ended on target goes on from the target, so the tolerance
+  // doesn't add up over the moves.
+  //
+  if (!drive.fOnTarget)
+  {
+    drive.clickTargetLeft = nMotorEncoder[drive.motorLeft];
+    drive.clickTargetRight = nMotorEncoder[drive.motorRight];
+#ifdef __HTGYRO_H__
+    drive.headingTarget = drive.headingGyro;
+#endif
+  }
+#ifdef __HTGYRO_H__
+  drive.clickTurnStart = (long)drive.clickTargetLeft - drive.clickTargetRight;
+#endif
+  drive.clickTargetLeft += clicksTarget;
+  drive.clickTargetRight += clicksTarget;
+  drive.fOnTarget = false;
   drive.errLeftPrev = clicksTarget;
   drive.errRightPrev = clicksTarget;
   drive.errLeftIntegral = 0;
   drive.errRightIntegral = 0;
+  DriveProfileStart(drive, clicksTarget, powerDrive);
+  drive.clickTolerance = drive.clickTolDistance;
+  drive.timeStart = CtrlTime();
+  drive.timeSettleStart = -1;
   drive.modeDrive = DRIVEMODE_PID_DISTANCE;
 
   TExit(API);
@@ -385,20 +1091,36 @@ DrivePIDSetAngle(
   __in int powerTurn
   )
 {
-  TFuncName("DrivePIDSetAngle");
-  TEnterMsg(API, ("A=%5.1f,Pwr=%d", setptAngle, powerTurn));
+  TFuncId(FID_DRIVEPIDSETANGLE);
+  TEnterMsg(API, ("A=%5.1f,Pwr=%d", TFloat(setptAngle, 1), powerTurn));
 
   int clicksTarget = (int)(setptAngle*drive.clicksPerDegree);
 
   powerTurn = BOUND(abs(powerTurn), 0, 100);
   drive.powerLeft = powerTurn;
   drive.powerRight = powerTurn;
-  drive.clickTargetLeft = nMotorEncoder[drive.motorLeft] + clicksTarget;
-  drive.clickTargetRight = nMotorEncoder[drive.motorRight] - clicksTarget;
+  if (!drive.fOnTarget)
+  {
+    drive.clickTargetLeft = nMotorEncoder[drive.motorLeft];
+    drive.clickTargetRight = nMotorEncoder[drive.motorRight];
+#ifdef __HTGYRO_H__
+    drive.headingTarget = drive.headingGyro;
+#endif
+  }
+#ifdef __HTGYRO_H__
+  drive.headingTarget += (long)(setptAngle*1000.0);
+#endif
+  drive.clickTargetLeft += clicksTarget;
+  drive.clickTargetRight -= clicksTarget;
+  drive.fOnTarget = false;
   drive.errLeftPrev = clicksTarget;
   drive.errRightPrev = -clicksTarget;
   drive.errLeftIntegral = 0;
   drive.errRightIntegral = 0;
+  DriveProfileStart(drive, clicksTarget, powerTurn);
+  drive.clickTolerance = drive.clickTolAngle;
+  drive.timeStart = CtrlTime();
+  drive.timeSettleStart = -1;
   drive.modeDrive = DRIVEMODE_PID_ANGLE;
 
   TExit(API);
@@ -420,12 +1142,28 @@ DriveTask(
   __inout DRIVE &drive
   )
 {
-  TFuncName("DriveTask");
-  TEnter(HIFREQ);
+  TFuncId(FID_DRIVETASK);
+  TSampleEnter(HIFREQ, TSMPID_DRIVE);
+  PrfEnter(PRFID_DRIVE);
 
   int errLeft, errRight, errDiff;
   int powerLeft, powerRight;
+  long pidLeft, pidRight;
+  int setptLeft, setptRight;
+  bool fProfiling = false;
+  bool fDone = false;
+  bool fSettled = false;
+  long timeNow = CtrlTime();
+  int ffLeft = 0;
+  int ffRight = 0;
+  int ff = 0;
+  int clickSteer = 0;
+  bool fHeadingHold = false;
 
+  DriveUpdateVelocity(drive, timeNow);
+#ifdef __HTGYRO_H__
+  DriveUpdateHeading(drive, timeNow);
+#endif
   switch (drive.modeDrive)
   {
     case DRIVEMODE_DRIVE:
@@ -435,8 +1173,74 @@ DriveTask(
 
     case DRIVEMODE_PID_DISTANCE:
     case DRIVEMODE_PID_ANGLE:
-      errLeft = drive.clickTargetLeft - nMotorEncoder[drive.motorLeft];
-      errRight = drive.clickTargetRight - nMotorEncoder[drive.motorRight];
+      setptLeft = drive.clickTargetLeft;
+      setptRight = drive.clickTargetRight;
+      if (drive.fProfile)
+      {
+        //
+        // Track the target of the motion profile until it has ended.
+        //
+        long time = timeNow - drive.profTimeStart;
+
+        if (drive.flagsDrive & DRIVEF_FIXED_PID)
+        {
+          long fracFixed = DriveProfileFractionFixed(drive, time);
+          long n;
+
+          fProfiling = time < drive.profTimeTotalFixed;
+          n = fracFixed*(drive.clickTargetLeft - drive.clickStartLeft);
+          setptLeft = drive.clickStartLeft + DRIVE_FIXED_INT(n);
+          n = fracFixed*(drive.clickTargetRight - drive.clickStartRight);
+          setptRight = drive.clickStartRight + DRIVE_FIXED_INT(n);
+          if (fProfiling)
+          {
+            n = DriveProfileFeedForwardFixed(drive, time);
+            ff = DRIVE_FIXED_INT(n);
+          }
+        }
+        else
+        {
+          float frac = DriveProfileFraction(drive, time);
+
+          fProfiling = time < drive.profTimeTotal;
+          setptLeft = drive.clickStartLeft +
+                      (int)(frac*(drive.clickTargetLeft -
+                                  drive.clickStartLeft));
+          setptRight = drive.clickStartRight +
+                       (int)(frac*(drive.clickTargetRight -
+                                   drive.clickStartRight));
+          if (fProfiling && ((drive.kV != 0.0) || (drive.kA != 0.0)))
+          {
+            ff = (int)DriveProfileFeedForward(drive, time);
+          }
+        }
+        //
+        // Feed the power the profile needs forward in the direction of
+        // each wheel.
+        //
+        ffLeft = (drive.clickTargetLeft >= drive.clickStartLeft)? ff: -ff;
+        ffRight = (drive.clickTargetRight >= drive.clickStartRight)? ff: -ff;
+      }
+#ifdef __HTGYRO_H__
+      if ((drive.modeDrive == DRIVEMODE_PID_DISTANCE) && (drive.idGyro >= 0))
+      {
+        //
+        // Steer the set points apart by the heading error the encoders
+        // don't see: the heading error of the gyro less what the wheels
+        // have turned off their targets since the start of the move.
+        //
+        clickSteer = (int)(((long)nMotorEncoder[drive.motorLeft] -
+                            nMotorEncoder[drive.motorRight] -
+                            drive.clickTurnStart)/2 +
+                           (drive.headingTarget - drive.headingGyro)*
+                           drive.clicksPerDegree/1000.0);
+        fHeadingHold = true;
+        setptLeft += clickSteer;
+        setptRight -= clickSteer;
+      }
+#endif
+      errLeft = setptLeft - nMotorEncoder[drive.motorLeft];
+      errRight = setptRight - nMotorEncoder[drive.motorRight];
       //
       // If we are going straight, we should try making errLeft and errRight the same.
       // Therefore, errDiff should be zero. If not, we will apply errDiff as a differential
@@ -450,14 +1254,34 @@ DriveTask(
       //
       drive.errLeftIntegral += errLeft;
       drive.errRightIntegral += errRight;
-      powerLeft = BOUND(drive.Kp*errLeft +
-                        drive.Ki*drive.errLeftIntegral +
-                        drive.Kd*(errLeft - drive.errLeftPrev),
-                        -drive.powerLeft, drive.powerLeft);
-      powerRight = BOUND(drive.Kp*errRight +
-                         drive.Ki*drive.errRightIntegral +
-                         drive.Kd*(errRight - drive.errRightPrev),
-                         -drive.powerRight, drive.powerRight);
+      if (drive.flagsDrive & DRIVEF_FIXED_PID)
+      {
+        pidLeft = (long)ffLeft*(1L << DRIVE_FIXED_SHIFT) +
+                  drive.KpFixed*errLeft +
+                  drive.KiFixed*drive.errLeftIntegral +
+                  drive.KdFixed*(errLeft - drive.errLeftPrev);
+        pidRight = (long)ffRight*(1L << DRIVE_FIXED_SHIFT) +
+                   drive.KpFixed*errRight +
+                   drive.KiFixed*drive.errRightIntegral +
+                   drive.KdFixed*(errRight - drive.errRightPrev);
+        powerLeft = BOUND(DRIVE_FIXED_INT(pidLeft),
+                          -drive.powerLeft, drive.powerLeft);
+        powerRight = BOUND(DRIVE_FIXED_INT(pidRight),
+                           -drive.powerRight, drive.powerRight);
+      }
+      else
+      {
+        powerLeft = BOUND(ffLeft +
+                          drive.Kp*errLeft +
+                          drive.Ki*drive.errLeftIntegral +
+                          drive.Kd*(errLeft - drive.errLeftPrev),
+                          -drive.powerLeft, drive.powerLeft);
+        powerRight = BOUND(ffRight +
+                           drive.Kp*errRight +
+                           drive.Ki*drive.errRightIntegral +
+                           drive.Kd*(errRight - drive.errRightPrev),
+                           -drive.powerRight, drive.powerRight);
+      }
       drive.errLeftPrev = errLeft;
       drive.errRightPrev = errRight;
 
@@ -491,9 +1315,66 @@ DriveTask(
                       (powerRight - errDiff + drive.powerRight);
           powerRight = -drive.powerRight;
         }
+        else if (fHeadingHold)
+        {
+          //
+          // The heading hold steers with the differential all the time,
+          // not only when a wheel is at its power limit.
+          //
+          powerLeft += errDiff;
+          powerRight -= errDiff;
+        }
+      }
+
+      //
+      // Check the completion criteria of the move.
+      //
+      if (drive.clickTolerance > 0)
+      {
+        //
+        // The criteria are checked against the final target, not the
+        // target of the profile, so a move can end in the tail of its
+        // profile. With the heading hold, the move also has to end on the
+        // heading.
+        //
+        errLeft = drive.clickTargetLeft + clickSteer -
+                  nMotorEncoder[drive.motorLeft];
+        errRight = drive.clickTargetRight - clickSteer -
+                   nMotorEncoder[drive.motorRight];
+        if ((abs(errLeft) <= drive.clickTolerance) &&
+            (abs(errRight) <= drive.clickTolerance) &&
+            (abs(drive.velLeft) <= drive.velTolerance) &&
+            (abs(drive.velRight) <= drive.velTolerance) &&
+            (!fHeadingHold ||
+             (abs(errLeft - errRight)/2 <= drive.clickTolAngle)))
+        {
+          if (drive.timeSettleStart < 0)
+          {
+            drive.timeSettleStart = timeNow;
+          }
+          fSettled = timeNow - drive.timeSettleStart >= drive.timeSettle;
+        }
+        else
+        {
+          drive.timeSettleStart = -1;
+        }
+        fDone = fSettled;
+      }
+      else
+      {
+        //
+        // Without the criteria, the move is done when its profile has
+        // ended and the PID power of a wheel has dropped under 2.
+        //
+        fDone = !fProfiling &&
+                ((abs(powerLeft) <= 1) || (abs(powerRight) <= 1));
+      }
+      if ((drive.timeMax > 0) && (timeNow - drive.timeStart >= drive.timeMax))
+      {
+        fDone = true;
       }
 
-      if ((abs(powerLeft) > 1) && (abs(powerRight) > 1))
+      if (!fDone)
       {
         motor[drive.motorLeft] = powerLeft;
         motor[drive.motorRight] = powerRight;
@@ -502,6 +1383,17 @@ DriveTask(
       {
         motor[drive.motorLeft] = 0;
         motor[drive.motorRight] = 0;
+        //
+        // Only a move that settled on target carries its target over to
+        // the next one.
+        //
+        drive.fOnTarget = fSettled;
+        //
+        // The targets of the wheels keep the steering of the heading hold,
+        // so the next move doesn't turn it back.
+        //
+        drive.clickTargetLeft += clickSteer;
+        drive.clickTargetRight -= clickSteer;
         if (drive.flagsDrive & DRIVEF_ENABLE_EVENTS)
         {
           DriveEvent(drive);
@@ -514,7 +1406,8 @@ DriveTask(
       break;
   }
 
-  TExit(HIFREQ);
+  PrfExit(PRFID_DRIVE);
+  TSampleExit(HIFREQ);
   return;
 }   //DriveTask
 
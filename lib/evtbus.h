@@ -0,0 +1,498 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="evtbus.h" />
+///
+/// <summary>
+///   This module contains the library functions of the event bus that
+///   dispatches the events of the robot to its subscribers.
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   A subscriber is a small ID picked by the caller, usually one per state
+///   machine. Each event type has a mask of the subscribers of the type,
+///   so EvtBusPublish only visits the subscribers of the event type. RobotC
+///   has no function pointers, so the bus calls the EvtBusDeliver function
+///   of the caller with the subscriber ID, which typically passes the event
+///   to SMSetEvent of the state machine of that subscriber. The event types
+///   are the ones of the state machines, so this module must be included
+///   after sm.h.
+///   Events can also be posted to an event queue and published later by
+///   EvtQueueDrain at a fixed point of the main loop. The queue is a ring
+///   with one producer and one consumer: only the producer moves the head
+///   and only the consumer moves the tail, so it needs no lock between
+///   RobotC tasks. Each producer task needs its own queue. A post to a
+///   full queue is dropped and counted. The queue also keeps the time the
+///   events wait between the post and the drain.
+/// </remarks>
+#endif
+
+#ifndef _EVTBUS_H
+#define _EVTBUS_H
+
+#pragma systemFile
+
+#ifdef MOD_ID
+  #undef MOD_ID
+#endif
+#define MOD_ID                  MOD_EVTBUS
+
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_EVTBUSINIT          (FIDBASE_EVTBUS + 0)
+#define FID_EVTBUSSUBSCRIBE     (FIDBASE_EVTBUS + 1)
+#define FID_EVTBUSUNSUBSCRIBE   (FIDBASE_EVTBUS + 2)
+#define FID_EVTBUSPUBLISH       (FIDBASE_EVTBUS + 3)
+#define FID_EVTQUEUEINIT        (FIDBASE_EVTBUS + 4)
+#define FID_EVTQUEUEPOST        (FIDBASE_EVTBUS + 5)
+#define FID_EVTQUEUEDRAIN       (FIDBASE_EVTBUS + 6)
+#define FID_EVTQUEUEDUMP        (FIDBASE_EVTBUS + 7)
+
+#ifdef _TRACE_FUNCNAMES
+string g_EvtbusFuncNames[8] =
+{
+  "EvtBusInit",
+  "EvtBusSubscribe",
+  "EvtBusUnsubscribe",
+  "EvtBusPublish",
+  "EvtQueueInit",
+  "EvtQueuePost",
+  "EvtQueueDrain",
+  "EvtQueueDump"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_EvtbusFuncNames
+
+//
+// End of generated function IDs.
+//
+
+//
+// Constants.
+//
+#ifndef MAX_BUS_SUBSCRIBERS
+  #define MAX_BUS_SUBSCRIBERS   8
+#endif
+#if MAX_BUS_SUBSCRIBERS > 32
+  #error MAX_BUS_SUBSCRIBERS must not exceed the bits in the long masks
+#endif
+#ifndef EVTQ_SIZE
+  #define EVTQ_SIZE             16      //must be a power of 2
+#endif
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  long typeMasks[MAX_EVT_TYPES];
+  long cntEvents;
+  long cntDeliveries;
+} EVTBUS;
+
+typedef struct
+{
+  int  evtType;
+  int  evtID;
+  int  evtData;
+  int  evtParam1;
+  int  evtParam2;
+  long timePosted;
+} EVT_RECORD;
+
+typedef struct
+{
+  int  head;                    //only moved by the producer
+  int  tail;                    //only moved by the consumer
+  long cntPosts;
+  long cntOverflows;
+  int  maxDepth;
+  long cntDrained;
+  long timeLatTotal;
+  long timeLatMax;
+  EVT_RECORD Records[EVTQ_SIZE];
+} EVTQUEUE;
+
+//
+// Import function prototypes.
+//
+void
+EvtBusDeliver(
+  __in int idSub,
+  __in int evtType,
+  __in int evtID,
+  __in int evtData,
+  __in int evtParam1,
+  __in int evtParam2
+  );
+
+/// <summary>
+///   This function initializes the event bus.
+/// </summary>
+///
+/// <param name="bus">
+///   Points to the EVTBUS structure to be initialized.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+EvtBusInit(
+  __out EVTBUS &bus
+  )
+{
+  TFuncId(FID_EVTBUSINIT);
+  TEnter(INIT);
+
+  for (int i = 0; i < MAX_EVT_TYPES; ++i)
+  {
+    bus.typeMasks[i] = 0;
+  }
+  bus.cntEvents = 0;
+  bus.cntDeliveries = 0;
+
+  TExit(INIT);
+  return;
+}   //EvtBusInit
+
+/// <summary>
+///   This function subscribes to an event type.
+/// </summary>
+///
+/// <param name="bus">
+///   Points to the EVTBUS structure.
+/// </param>
+/// <param name="idSub">
+///   Specifies the subscriber ID.
+/// </param>
+/// <param name="evtType">
+///   Specifies the event type.
+/// </param>
+///
+/// <returns> Success: Return true. </returns>
+/// <returns> Failure: Return false. </returns>
+
+bool
+EvtBusSubscribe(
+  __inout EVTBUS &bus,
+  __in int idSub,
+  __in int evtType
+  )
+{
+  TFuncId(FID_EVTBUSSUBSCRIBE);
+  TEnterMsg(API, ("Sub=%d,Type=%x", idSub, evtType));
+
+  bool fOK = false;
+
+  if ((idSub < 0) || (idSub >= MAX_BUS_SUBSCRIBERS) ||
+      (evtType < 0) || (evtType >= MAX_EVT_TYPES))
+  {
+    TErr(("Invalid Sub=%d,Type=%x", idSub, evtType));
+  }
+  else
+  {
+    bus.typeMasks[evtType] |= SMEvtBit(idSub);
+    fOK = true;
+  }
+
+  TExitMsg(API, ("fOK=%d", (byte)fOK));
+  return fOK;
+}   //EvtBusSubscribe
+
+/// <summary>
+///   This function unsubscribes from an event type.
+/// </summary>
+///
+/// <param name="bus">
+///   Points to the EVTBUS structure.
+/// </param>
+/// <param name="idSub">
+///   Specifies the subscriber ID.
+/// </param>
+/// <param name="evtType">
+///   Specifies the event type.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+EvtBusUnsubscribe(
+  __inout EVTBUS &bus,
+  __in int idSub,
+  __in int evtType
+  )
+{
+  TFuncId(FID_EVTBUSUNSUBSCRIBE);
+  TEnterMsg(API, ("Sub=%d,Type=%x", idSub, evtType));
+
+  if ((idSub >= 0) && (idSub < MAX_BUS_SUBSCRIBERS) &&
+      (evtType >= 0) && (evtType < MAX_EVT_TYPES))
+  {
+    bus.typeMasks[evtType] &= ~SMEvtBit(idSub);
+  }
+
+  TExit(API);
+  return;
+}   //EvtBusUnsubscribe
+
+/// <summary>
+///   This function publishes an event to all the subscribers of its type.
+/// </summary>
+///
+/// <param name="bus">
+///   Points to the EVTBUS structure.
+/// </param>
+/// <param name="evtType">
+///   Specifies the event type.
+/// </param>
+/// <param name="evtID">
+///   Specifies the event ID.
+/// </param>
+/// <param name="evtData">
+///   Specifies the event data.
+/// </param>
+/// <param name="evtParam1">
+///   Specifies the event parameter 1.
+/// </param>
+/// <param name="evtParam2">
+///   Specifies the event parameter 2.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+EvtBusPublish(
+  __inout EVTBUS &bus,
+  __in int evtType,
+  __in int evtID,
+  __in int evtData,
+  __in int evtParam1,
+  __in int evtParam2
+  )
+{
+  TFuncId(FID_EVTBUSPUBLISH);
+  TEnterMsg(EVENT, ("Type=%x,ID=%x", evtType, evtID));
+
+  long subs = ((evtType >= 0) && (evtType < MAX_EVT_TYPES))?
+              bus.typeMasks[evtType]: 0;
+
+  bus.cntEvents++;
+  for (int i = 0; subs != 0; ++i)
+  {
+    if (subs & SMEvtBit(i))
+    {
+      subs &= ~SMEvtBit(i);
+      bus.cntDeliveries++;
+      EvtBusDeliver(i, evtType, evtID, evtData, evtParam1, evtParam2);
+    }
+  }
+
+  TExit(EVENT);
+  return;
+}   //EvtBusPublish
+
+/// <summary>
+///   This function initializes an event queue.
+/// </summary>
+///
+/// <param name="queue">
+///   Points to the EVTQUEUE structure to be initialized.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+EvtQueueInit(
+  __out EVTQUEUE &queue
+  )
+{
+  TFuncId(FID_EVTQUEUEINIT);
+  TEnter(INIT);
+
+  queue.head = 0;
+  queue.tail = 0;
+  queue.cntPosts = 0;
+  queue.cntOverflows = 0;
+  queue.maxDepth = 0;
+  queue.cntDrained = 0;
+  queue.timeLatTotal = 0;
+  queue.timeLatMax = 0;
+
+  TExit(INIT);
+  return;
+}   //EvtQueueInit
+
+/// <summary>
+///   This function posts an event to an event queue. It must only be called
+///   by the producer task of the queue.
+/// </summary>
+///
+/// <param name="queue">
+///   Points to the EVTQUEUE structure.
+/// </param>
+/// <param name="evtType">
+///   Specifies the event type.
+/// </param>
+/// <param name="evtID">
+///   Specifies the event ID.
+/// </param>
+/// <param name="evtData">
+///   Specifies the event data.
+/// </param>
+/// <param name="evtParam1">
+///   Specifies the event parameter 1.
+/// </param>
+/// <param name="evtParam2">
+///   Specifies the event parameter 2.
+/// </param>
+///
+/// <returns> Success: Return true. </returns>
+/// <returns> Failure: Return false if the queue is full. </returns>
+
+bool
+EvtQueuePost(
+  __inout EVTQUEUE &queue,
+  __in int evtType,
+  __in int evtID,
+  __in int evtData,
+  __in int evtParam1,
+  __in int evtParam2
+  )
+{
+  TFuncId(FID_EVTQUEUEPOST);
+  TEnterMsg(EVENT, ("Type=%x,ID=%x", evtType, evtID));
+
+  bool fPosted = false;
+  int head = queue.head;
+  int next = (head + 1) & (EVTQ_SIZE - 1);
+  int depth;
+
+  if (next == queue.tail)
+  {
+    queue.cntOverflows++;
+    TWarn(("Overflow Type=%x,ID=%x", evtType, evtID));
+  }
+  else
+  {
+    queue.Records[head].evtType = evtType;
+    queue.Records[head].evtID = evtID;
+    queue.Records[head].evtData = evtData;
+    queue.Records[head].evtParam1 = evtParam1;
+    queue.Records[head].evtParam2 = evtParam2;
+    queue.Records[head].timePosted = nPgmTime;
+    //
+    // The record must be filled in before the head moves past it.
+    //
+    queue.head = next;
+    queue.cntPosts++;
+    depth = (next - queue.tail) & (EVTQ_SIZE - 1);
+    if (depth > queue.maxDepth)
+    {
+      queue.maxDepth = depth;
+    }
+    fPosted = true;
+  }
+
+  TExitMsg(EVENT, ("fOK=%d", (byte)fPosted));
+  return fPosted;
+}   //EvtQueuePost
+
+/// <summary>
+///   This function publishes the events in an event queue to the event bus.
+///   It must only be called by the consumer task of the queue. The events
+///   posted while draining are left for the next call.
+/// </summary>
+///
+/// <param name="queue">
+///   Points to the EVTQUEUE structure.
+/// </param>
+/// <param name="bus">
+///   Points to the EVTBUS structure.
+/// </param>
+///
+/// <returns> Returns the number of events published. </returns>
+
+int
+EvtQueueDrain(
+  __inout EVTQUEUE &queue,
+  __inout EVTBUS &bus
+  )
+{
+  TFuncId(FID_EVTQUEUEDRAIN);
+  TEnter(HIFREQ);
+
+  int head = queue.head;
+  int tail = queue.tail;
+  int cntEvents = 0;
+  long timeLat;
+
+  while (tail != head)
+  {
+    timeLat = nPgmTime - queue.Records[tail].timePosted;
+    queue.cntDrained++;
+    queue.timeLatTotal += timeLat;
+    if (timeLat > queue.timeLatMax)
+    {
+      queue.timeLatMax = timeLat;
+    }
+    EvtBusPublish(bus,
+                  queue.Records[tail].evtType,
+                  queue.Records[tail].evtID,
+                  queue.Records[tail].evtData,
+                  queue.Records[tail].evtParam1,
+                  queue.Records[tail].evtParam2);
+    tail = (tail + 1) & (EVTQ_SIZE - 1);
+    //
+    // The record is free once the tail moves past it.
+    //
+    queue.tail = tail;
+    cntEvents++;
+  }
+
+  TExitMsg(HIFREQ, ("nEvts=%d", cntEvents));
+  return cntEvents;
+}   //EvtQueueDrain
+
+/// <summary>
+///   This function prints the statistics of an event queue to the debug
+///   stream.
+/// </summary>
+///
+/// <param name="queue">
+///   Points to the EVTQUEUE structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+EvtQueueDump(
+  __in EVTQUEUE &queue
+  )
+{
+  TFuncId(FID_EVTQUEUEDUMP);
+  TEnter(UTIL);
+
+  debugPrintLine("EvtQueue: posts/overflows/depth");
+  debugPrintLine("%d/%d/%d",
+                 queue.cntPosts, queue.cntOverflows, queue.maxDepth);
+  if (queue.cntDrained > 0)
+  {
+    debugPrintLine("EvtQueue latency: msec avg/max (n)");
+    debugPrintLine("%d.%02d/%d (%d)",
+                   queue.timeLatTotal/queue.cntDrained,
+                   queue.timeLatTotal*100/queue.cntDrained%100,
+                   queue.timeLatMax,
+                   queue.cntDrained);
+  }
+
+  TExit(UTIL);
+  return;
+}   //EvtQueueDump
+
+#endif  //ifndef _EVTBUS_H
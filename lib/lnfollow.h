@@ -22,6 +22,31 @@
 #endif
 #define MOD_ID                  MOD_LNFOLLOW
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_LNFOLLOWINIT        (FIDBASE_LNFOLLOW + 0)
+#define FID_LNFOLLOWCAL         (FIDBASE_LNFOLLOW + 1)
+#define FID_LNFOLLOWTASK        (FIDBASE_LNFOLLOW + 2)
+
+#ifdef _TRACE_FUNCNAMES
+string g_LnfollowFuncNames[3] =
+{
+  "LnFollowInit",
+  "LnFollowCal",
+  "LnFollowTask"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_LnfollowFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Constants.
 //
@@ -108,7 +133,7 @@ LnFollowInit(
 #endif
   )
 {
-  TFuncName("LnFollowInit");
+  TFuncId(FID_LNFOLLOWINIT);
   TEnter(INIT);
 
   lnfollow.numLightSensors = numLightSensors;
@@ -147,7 +172,7 @@ LnFollowCal(
   __in bool fStart
   )
 {
-  TFuncName("LnFollowCal");
+  TFuncId(FID_LNFOLLOWCAL);
   TEnterMsg(API, ("fStart=%d", (byte)fStart));
 
   if (fStart)
@@ -183,8 +208,9 @@ LnFollowTask(
   __inout LNFOLLOW &lnfollow
   )
 {
-  TFuncName("LnFollowTask");
-  TEnter(HIFREQ);
+  TFuncId(FID_LNFOLLOWTASK);
+  TSampleEnter(HIFREQ, TSMPID_LNFOLLOW);
+  PrfEnter(PRFID_LNFOLLOW);
 
   lnfollow.valueWeighted = 0;
   for (int i = 0; i < lnfollow.numLightSensors; i++)
@@ -260,7 +286,8 @@ LnFollowTask(
 
   lnfollow.valuePrev = valueCurr;
 
-  TExit(HIFREQ);
+  PrfExit(PRFID_LNFOLLOW);
+  TSampleExit(HIFREQ);
   return;
 }   //LnFollowTask
 
@@ -0,0 +1,652 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="profile.h" />
+///
+/// <summary>
+///   This module contains the cycle time profiler functions and definitions.
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   The profiler is only compiled in when _PROFILE is defined. All the
+///   storage is preallocated and the enter/exit hooks do no formatting.
+///   Times are in msec since that is the resolution of nPgmTime.
+///   When _PROFILE_FUNCS is defined, the TEnter/TExit hooks of trace.h also
+///   accumulate the call count, inclusive and exclusive time of every
+///   traced function and of every caller/callee pair. Most functions take
+///   well under a msec, so a call only gets charged when a msec tick falls
+///   inside it. Over many calls this samples the time spent in each
+///   function at a 1 msec interval. The hooks keep a single call stack, so
+///   only the functions called from the main task should be traced.
+/// </remarks>
+#endif
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#pragma systemFile
+
+//
+// Profile slot IDs.
+//
+#define PRFID_BUTTON            0
+#define PRFID_SENSOR            1
+#define PRFID_DRIVE             2
+#define PRFID_LNFOLLOW          3
+#define PRFID_USER              4
+
+#ifndef MAX_PRF_SLOTS
+  #define MAX_PRF_SLOTS         10
+#endif
+#ifndef PRF_NUM_BUCKETS
+  #define PRF_NUM_BUCKETS       16      //1 msec each, last one is overflow
+#endif
+
+//
+// Function profiler constants. The table sizes must be powers of 2.
+//
+#define PRFFID_I2C              (FIDBASE_DRIVERS + 0)
+#ifndef MAX_PRF_FUNCS
+  #define MAX_PRF_FUNCS         64
+#endif
+#ifndef MAX_PRF_EDGES
+  #define MAX_PRF_EDGES         64
+#endif
+#ifndef MAX_PRF_DEPTH
+  #define MAX_PRF_DEPTH         12
+#endif
+#define PRF_ROOT                MAX_PRF_FUNCS   //caller index of the root
+
+//
+// Profile macros.
+//
+#ifdef _PROFILE
+  #define PrfEnter(id)          g_PrfSlots[id].timeStart = nPgmTime
+  #define PrfExit(id)           PrfRecord(id, nPgmTime - g_PrfSlots[id].timeStart)
+#else
+  #define PrfEnter(id)
+  #define PrfExit(id)
+  #define PrfInit()
+  #define PrfReset()
+  #define PrfSetName(id,s)
+  #define PrfDump()
+#endif
+
+#ifdef _PROFILE_FUNCS
+  //
+  // The name is only copied on the first call of each function.
+  //
+  #define PrfFuncBegin(id,s)    if (PrfFuncEnter(id)) \
+                                { \
+                                  PrfFuncSetName(id, s); \
+                                }
+  #define PrfFuncEnd(id)        PrfFuncExit(id)
+  #define PrfEdgeKey(r,e)       ((r)*(MAX_PRF_FUNCS + 1) + (e) + 1)
+#else
+  #define PrfFuncBegin(id,s)
+  #define PrfFuncEnd(id)
+  #define PrfFuncReset()
+  #define PrfFuncDump()
+#endif
+
+#ifdef _PROFILE
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  string name;
+  long   cntCalls;
+  long   timeTotal;
+  long   timeStart;
+  int    timeMin;
+  int    timeMax;
+} PRF_SLOT;
+
+//
+// Global data.
+//
+PRF_SLOT g_PrfSlots[MAX_PRF_SLOTS];
+long     g_PrfHist[MAX_PRF_SLOTS*PRF_NUM_BUCKETS];
+
+/// <summary>
+///   This function clears the accumulated statistics of all profile slots.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+PrfReset()
+{
+  for (int i = 0; i < MAX_PRF_SLOTS; ++i)
+  {
+    g_PrfSlots[i].cntCalls = 0;
+    g_PrfSlots[i].timeTotal = 0;
+    g_PrfSlots[i].timeStart = 0;
+    g_PrfSlots[i].timeMin = 0;
+    g_PrfSlots[i].timeMax = 0;
+  }
+
+  for (int i = 0; i < MAX_PRF_SLOTS*PRF_NUM_BUCKETS; ++i)
+  {
+    g_PrfHist[i] = 0;
+  }
+
+  return;
+}   //PrfReset
+
+/// <summary>
+///   This function initializes the profiler and names the library slots.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+PrfInit()
+{
+  for (int i = 0; i < MAX_PRF_SLOTS; ++i)
+  {
+    g_PrfSlots[i].name = "";
+  }
+  g_PrfSlots[PRFID_BUTTON].name = "ButtonTask";
+  g_PrfSlots[PRFID_SENSOR].name = "SensorTask";
+  g_PrfSlots[PRFID_DRIVE].name = "DriveTask";
+  g_PrfSlots[PRFID_LNFOLLOW].name = "LnFollowTask";
+  PrfReset();
+
+  return;
+}   //PrfInit
+
+/// <summary>
+///   This function names a user profile slot.
+/// </summary>
+///
+/// <param name="id">
+///   Specifies the profile slot ID.
+/// </param>
+/// <param name="name">
+///   Specifies the name to be printed in the summary.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+PrfSetName(
+  __in int id,
+  __in string name
+  )
+{
+  if ((id >= 0) && (id < MAX_PRF_SLOTS))
+  {
+    g_PrfSlots[id].name = name;
+  }
+
+  return;
+}   //PrfSetName
+
+/// <summary>
+///   This function records one sample of a profile slot.
+/// </summary>
+///
+/// <param name="id">
+///   Specifies the profile slot ID.
+/// </param>
+/// <param name="timeElapsed">
+///   Specifies the elapsed time of the sample in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+PrfRecord(
+  __in int id,
+  __in int timeElapsed
+  )
+{
+  if (g_PrfSlots[id].cntCalls == 0)
+  {
+    g_PrfSlots[id].timeMin = timeElapsed;
+    g_PrfSlots[id].timeMax = timeElapsed;
+  }
+  else if (timeElapsed < g_PrfSlots[id].timeMin)
+  {
+    g_PrfSlots[id].timeMin = timeElapsed;
+  }
+  else if (timeElapsed > g_PrfSlots[id].timeMax)
+  {
+    g_PrfSlots[id].timeMax = timeElapsed;
+  }
+  g_PrfSlots[id].cntCalls++;
+  g_PrfSlots[id].timeTotal += timeElapsed;
+  g_PrfHist[id*PRF_NUM_BUCKETS +
+            BOUND(timeElapsed, 0, PRF_NUM_BUCKETS - 1)]++;
+
+  return;
+}   //PrfRecord
+
+/// <summary>
+///   This function prints the profile summary of all slots that have
+///   samples to the debug stream.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+PrfDump()
+{
+  debugPrintLine("Profile: msec min/avg/p99/max (n)");
+  for (int i = 0; i < MAX_PRF_SLOTS; ++i)
+  {
+    if (g_PrfSlots[i].cntCalls > 0)
+    {
+      //
+      // The p99 value is the first bucket where the cumulative count
+      // reaches 99% of the samples. The average is in 1/100 msec.
+      //
+      long cntP99 = (g_PrfSlots[i].cntCalls*99 + 99)/100;
+      long cntSum = 0;
+      int p99 = PRF_NUM_BUCKETS - 1;
+
+      for (int j = 0; j < PRF_NUM_BUCKETS; ++j)
+      {
+        cntSum += g_PrfHist[i*PRF_NUM_BUCKETS + j];
+        if (cntSum >= cntP99)
+        {
+          p99 = j;
+          break;
+        }
+      }
+      debugPrintLine("%s: %d/%d.%02d/%d/%d (%d)",
+                     g_PrfSlots[i].name,
+                     g_PrfSlots[i].timeMin,
+                     g_PrfSlots[i].timeTotal/g_PrfSlots[i].cntCalls,
+                     g_PrfSlots[i].timeTotal*100/g_PrfSlots[i].cntCalls%100,
+                     p99,
+                     g_PrfSlots[i].timeMax,
+                     g_PrfSlots[i].cntCalls);
+    }
+  }
+
+  return;
+}   //PrfDump
+
+#endif  //ifdef _PROFILE
+
+#ifdef _PROFILE_FUNCS
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int    idFunc;                //0 if the entry is free
+  string name;
+  long   cntCalls;
+  long   timeIncl;
+  long   timeExcl;
+} PRF_FUNC;
+
+typedef struct
+{
+  int    key;                   //PrfEdgeKey, 0 if the entry is free
+  long   cntCalls;
+  long   timeIncl;
+} PRF_EDGE;
+
+typedef struct
+{
+  int    idFunc;
+  int    iFunc;
+  int    iEdge;
+  long   timeEnter;
+  long   timeChild;
+} PRF_FRAME;
+
+//
+// Global data.
+//
+PRF_FUNC  g_PrfFuncs[MAX_PRF_FUNCS];
+PRF_EDGE  g_PrfEdges[MAX_PRF_EDGES];
+PRF_FRAME g_PrfStack[MAX_PRF_DEPTH];
+int       g_PrfDepth = 0;
+long      g_PrfFuncsLost = 0;
+
+/// <summary>
+///   This function clears the function profile.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+PrfFuncReset()
+{
+  for (int i = 0; i < MAX_PRF_FUNCS; ++i)
+  {
+    g_PrfFuncs[i].idFunc = 0;
+    g_PrfFuncs[i].name = "";
+    g_PrfFuncs[i].cntCalls = 0;
+    g_PrfFuncs[i].timeIncl = 0;
+    g_PrfFuncs[i].timeExcl = 0;
+  }
+
+  for (int i = 0; i < MAX_PRF_EDGES; ++i)
+  {
+    g_PrfEdges[i].key = 0;
+    g_PrfEdges[i].cntCalls = 0;
+    g_PrfEdges[i].timeIncl = 0;
+  }
+  g_PrfDepth = 0;
+  g_PrfFuncsLost = 0;
+
+  return;
+}   //PrfFuncReset
+
+/// <summary>
+///   This function finds the call graph edge between two functions and
+///   creates it if it is not there yet.
+/// </summary>
+///
+/// <param name="iCaller">
+///   Specifies the function table index of the caller, PRF_ROOT if none.
+/// </param>
+/// <param name="iCallee">
+///   Specifies the function table index of the callee.
+/// </param>
+///
+/// <returns> Returns the edge index, -1 if the edge table is full. </returns>
+
+int
+PrfFuncEdge(
+  __in int iCaller,
+  __in int iCallee
+  )
+{
+  int key = PrfEdgeKey(iCaller, iCallee);
+  int i = (iCaller*5 + iCallee) & (MAX_PRF_EDGES - 1);
+
+  for (int n = 0; n < MAX_PRF_EDGES; ++n)
+  {
+    if (g_PrfEdges[i].key == key)
+    {
+      return i;
+    }
+    else if (g_PrfEdges[i].key == 0)
+    {
+      g_PrfEdges[i].key = key;
+      return i;
+    }
+    i = (i + 1) & (MAX_PRF_EDGES - 1);
+  }
+
+  return -1;
+}   //PrfFuncEdge
+
+/// <summary>
+///   This function is called by the TEnter hook. It finds the function in
+///   the hash table, creating the entry on the first call, and pushes a
+///   frame on the call stack.
+/// </summary>
+///
+/// <param name="idFunc">
+///   Specifies the function ID.
+/// </param>
+///
+/// <returns> Returns true if this is the first call of the function. </returns>
+
+bool
+PrfFuncEnter(
+  __in int idFunc
+  )
+{
+  bool fNew = false;
+  int i = (idFunc ^ (idFunc >> 5)) & (MAX_PRF_FUNCS - 1);
+  int n;
+
+  for (n = 0; n < MAX_PRF_FUNCS; ++n)
+  {
+    if (g_PrfFuncs[i].idFunc == idFunc)
+    {
+      break;
+    }
+    else if (g_PrfFuncs[i].idFunc == 0)
+    {
+      g_PrfFuncs[i].idFunc = idFunc;
+      fNew = true;
+      break;
+    }
+    i = (i + 1) & (MAX_PRF_FUNCS - 1);
+  }
+
+  if (n == MAX_PRF_FUNCS)
+  {
+    i = -1;
+    g_PrfFuncsLost++;
+  }
+
+  if (g_PrfDepth < MAX_PRF_DEPTH)
+  {
+    g_PrfStack[g_PrfDepth].idFunc = idFunc;
+    g_PrfStack[g_PrfDepth].iFunc = i;
+    g_PrfStack[g_PrfDepth].iEdge = -1;
+    if (i != -1)
+    {
+      int iCaller = (g_PrfDepth > 0)? g_PrfStack[g_PrfDepth - 1].iFunc:
+                                      PRF_ROOT;
+      if (iCaller != -1)
+      {
+        g_PrfStack[g_PrfDepth].iEdge = PrfFuncEdge(iCaller, i);
+      }
+    }
+    g_PrfStack[g_PrfDepth].timeChild = 0;
+    g_PrfStack[g_PrfDepth].timeEnter = nPgmTime;
+  }
+  else
+  {
+    g_PrfFuncsLost++;
+  }
+  //
+  // The depth is counted even past the end of the stack so that the exits
+  // still match.
+  //
+  g_PrfDepth++;
+
+  return fNew;
+}   //PrfFuncEnter
+
+/// <summary>
+///   This function names a function entry.
+/// </summary>
+///
+/// <param name="idFunc">
+///   Specifies the function ID.
+/// </param>
+/// <param name="name">
+///   Specifies the function name.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+PrfFuncSetName(
+  __in int idFunc,
+  __in string name
+  )
+{
+  int i = (idFunc ^ (idFunc >> 5)) & (MAX_PRF_FUNCS - 1);
+
+  for (int n = 0; n < MAX_PRF_FUNCS; ++n)
+  {
+    if (g_PrfFuncs[i].idFunc == idFunc)
+    {
+      g_PrfFuncs[i].name = name;
+      break;
+    }
+    i = (i + 1) & (MAX_PRF_FUNCS - 1);
+  }
+
+  return;
+}   //PrfFuncSetName
+
+/// <summary>
+///   This function pops the top frame off the call stack and charges its
+///   time to the function, the call graph edge and the caller.
+/// </summary>
+///
+/// <param name="timeCurr">
+///   Specifies the current time.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+PrfFuncPop(
+  __in long timeCurr
+  )
+{
+  g_PrfDepth--;
+  if (g_PrfDepth < MAX_PRF_DEPTH)
+  {
+    long timeElapsed = timeCurr - g_PrfStack[g_PrfDepth].timeEnter;
+    int iFunc = g_PrfStack[g_PrfDepth].iFunc;
+    int iEdge = g_PrfStack[g_PrfDepth].iEdge;
+
+    if (iFunc != -1)
+    {
+      g_PrfFuncs[iFunc].cntCalls++;
+      g_PrfFuncs[iFunc].timeIncl += timeElapsed;
+      g_PrfFuncs[iFunc].timeExcl += timeElapsed -
+                                    g_PrfStack[g_PrfDepth].timeChild;
+    }
+
+    if (iEdge != -1)
+    {
+      g_PrfEdges[iEdge].cntCalls++;
+      g_PrfEdges[iEdge].timeIncl += timeElapsed;
+    }
+
+    if (g_PrfDepth > 0)
+    {
+      g_PrfStack[g_PrfDepth - 1].timeChild += timeElapsed;
+    }
+  }
+
+  return;
+}   //PrfFuncPop
+
+/// <summary>
+///   This function is called by the TExit hook. Frames of functions that
+///   returned without going through TExit are popped as well.
+/// </summary>
+///
+/// <param name="idFunc">
+///   Specifies the function ID.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+PrfFuncExit(
+  __in int idFunc
+  )
+{
+  long timeCurr = nPgmTime;
+
+  while ((g_PrfDepth > 0) && (g_PrfDepth <= MAX_PRF_DEPTH) &&
+         (g_PrfStack[g_PrfDepth - 1].idFunc != idFunc))
+  {
+    PrfFuncPop(timeCurr);
+  }
+
+  if (g_PrfDepth > 0)
+  {
+    PrfFuncPop(timeCurr);
+  }
+
+  return;
+}   //PrfFuncExit
+
+/// <summary>
+///   This function prints the flat profile sorted by exclusive time and
+///   then the callees of each function to the debug stream.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+PrfFuncDump()
+{
+  bool Printed[MAX_PRF_FUNCS];
+  long timeTotal = 0;
+
+  for (int i = 0; i < MAX_PRF_FUNCS; ++i)
+  {
+    Printed[i] = false;
+    timeTotal += g_PrfFuncs[i].timeExcl;
+  }
+  if (timeTotal == 0)
+  {
+    timeTotal = 1;
+  }
+
+  debugPrintLine("Flat: pct excl/incl msec (n)");
+  for (int n = 0; n < MAX_PRF_FUNCS; ++n)
+  {
+    int iMax = -1;
+
+    for (int i = 0; i < MAX_PRF_FUNCS; ++i)
+    {
+      if (!Printed[i] && (g_PrfFuncs[i].cntCalls > 0) &&
+          ((iMax == -1) ||
+           (g_PrfFuncs[i].timeExcl > g_PrfFuncs[iMax].timeExcl)))
+      {
+        iMax = i;
+      }
+    }
+
+    if (iMax == -1)
+    {
+      break;
+    }
+    Printed[iMax] = true;
+    debugPrintLine("%s: %d %d/%d (%d)",
+                   g_PrfFuncs[iMax].name,
+                   g_PrfFuncs[iMax].timeExcl*100/timeTotal,
+                   g_PrfFuncs[iMax].timeExcl,
+                   g_PrfFuncs[iMax].timeIncl,
+                   g_PrfFuncs[iMax].cntCalls);
+  }
+
+  debugPrintLine("Calls: caller>callee incl msec (n)");
+  for (int i = 0; i < MAX_PRF_EDGES; ++i)
+  {
+    if (g_PrfEdges[i].cntCalls > 0)
+    {
+      int iCaller = (g_PrfEdges[i].key - 1)/(MAX_PRF_FUNCS + 1);
+      int iCallee = (g_PrfEdges[i].key - 1)%(MAX_PRF_FUNCS + 1);
+      string caller = "-";
+
+      if (iCaller != PRF_ROOT)
+      {
+        caller = g_PrfFuncs[iCaller].name;
+      }
+      debugPrintLine("%s>%s %d (%d)",
+                     caller,
+                     g_PrfFuncs[iCallee].name,
+                     g_PrfEdges[i].timeIncl,
+                     g_PrfEdges[i].cntCalls);
+    }
+  }
+
+  if (g_PrfFuncsLost > 0)
+  {
+    debugPrintLine("Lost: %d", g_PrfFuncsLost);
+  }
+
+  return;
+}   //PrfFuncDump
+
+#endif  //ifdef _PROFILE_FUNCS
+
+#endif  //ifndef _PROFILE_H
@@ -0,0 +1,699 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="replay.h" />
+///
+/// <summary>
+///   This module contains the input recorder and replayer functions and
+///   definitions.
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   The recorder is only compiled in when _REPLAY is defined. In record
+///   mode, every loop cycle is written to a log file as one frame that
+///   contains the joystick (only when it changed), the encoders registered
+///   with RplAddEncoder and the sensor values read by SensorTask in the
+///   order they were read. In replay mode, the same frames are read back
+///   and fed to the program in place of the live inputs, so ButtonTask,
+///   SensorTask and DriveTask see exactly the recorded values on the same
+///   loop cycle. The drive motors still run during replay, so the robot
+///   should be off the ground.
+///   Each frame also has its cycle time, which is the time of the
+///   scheduler cycle. While recording or replaying, the control code runs
+///   on the frame time (CtrlTime) instead of nPgmTime, so the scheduler,
+///   the state machine timers, the drive and the shooter make the same
+///   decisions on the same frames even if the replay loop runs late. The
+///   clock of the log starts at RplInit, so it should be called before the
+///   init code reads CtrlTime.
+///   Values are stored as the change from the previous frame in one byte,
+///   or as an escape byte followed by a long if the change is too big. A
+///   frame is typically 6 bytes, so a 30 second autonomous run takes about
+///   18K of flash.
+///   Each frame also has the work time of the loop cycle. RplDump prints
+///   the recorded and replayed work times side by side, so a log recorded
+///   before a change can be replayed after it to compare the loop timing.
+/// </remarks>
+#endif
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#pragma systemFile
+
+//
+// Constants.
+//
+#define RPLMODE_OFF             0
+#define RPLMODE_RECORD          1
+#define RPLMODE_REPLAY          2
+
+#ifndef RPL_FILE_SIZE
+  #define RPL_FILE_SIZE         30000   //in bytes
+#endif
+#ifndef MAX_RPL_ENCODERS
+  #define MAX_RPL_ENCODERS      4
+#endif
+#ifndef MAX_RPL_SENSORS
+  #define MAX_RPL_SENSORS       8
+#endif
+
+#define RPL_MAGIC               0x5052  //"RP"
+#define RPL_VERSION             2
+#define RPL_ESCAPE              -128    //a long follows
+#define RPL_JOYSTICK_SIZE       15
+#define RPL_VALUE_SIZE          5       //escape byte and long
+
+//
+// Frame flags.
+//
+#define RPLF_JOYSTICK           0x01
+#define RPLF_USERMODE           0x01
+#define RPLF_STOPPGM            0x02
+
+//
+// Replay macros.
+//
+#ifdef _REPLAY
+  #define RplSensor(v)          v = RplSensorValue(v)
+  #define IsRplReplaying()      (g_Rpl.mode == RPLMODE_REPLAY)
+  #undef CtrlTime
+  #define CtrlTime()            RplTime()
+#else
+  #define RplInit(m,s)
+  #define RplAddEncoder(id)
+  #define RplFrameBegin(t)
+  #define RplJoystick(j)
+  #define RplSensor(v)
+  #define RplFrameEnd()
+  #define RplClose()
+  #define RplDump()
+  #define IsRplReplaying()      false
+#endif
+
+#ifdef _REPLAY
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int           mode;
+  bool          fStarted;
+  bool          fInFrame;
+  bool          fClosePending;
+  string        fileName;
+  TFileHandle   hFile;
+  TFileIOResult ioResult;
+  long          cntFrames;
+  long          cntBytes;
+  long          cntDropped;
+  long          timeFrame;
+  long          timePrev;
+  long          timeStart;
+  int           flagsFrame;
+  int           nEncoders;
+  int           idMotors[MAX_RPL_ENCODERS];
+  long          encValues[MAX_RPL_ENCODERS];
+  long          encPrev[MAX_RPL_ENCODERS];
+  int           nSensors;
+  int           iSensor;
+  int           sensorValues[MAX_RPL_SENSORS];
+  int           sensorPrev[MAX_RPL_SENSORS];
+  TJoystick     joystick;
+  int           timeWork;
+  long          timeWorkRec;
+  long          timeWorkPlay;
+  int           timeMaxRec;
+  int           timeMaxPlay;
+} RPL;
+
+//
+// Global data.
+//
+RPL g_Rpl;
+
+/// <summary>
+///   This function writes a value as one byte, or as the escape byte
+///   followed by a long if it does not fit.
+/// </summary>
+///
+/// <param name="value">
+///   Specifies the value.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+RplWriteValue(
+  __in long value
+  )
+{
+  if ((value > RPL_ESCAPE) && (value <= 127))
+  {
+    WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)value);
+    g_Rpl.cntBytes++;
+  }
+  else
+  {
+    WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)RPL_ESCAPE);
+    WriteLong(g_Rpl.hFile, g_Rpl.ioResult, value);
+    g_Rpl.cntBytes += RPL_VALUE_SIZE;
+  }
+
+  return;
+}   //RplWriteValue
+
+/// <summary>
+///   This function reads a byte as a signed value. The byte type may or may
+///   not be signed, so the sign is extended here.
+/// </summary>
+///
+/// <returns> Returns the value between -128 and 127. </returns>
+
+int
+RplReadByte()
+{
+  byte data = 0;
+  int value;
+
+  ReadByte(g_Rpl.hFile, g_Rpl.ioResult, data);
+  value = data & 0xff;
+  if (value >= 0x80)
+  {
+    value -= 0x100;
+  }
+
+  return value;
+}   //RplReadByte
+
+/// <summary>
+///   This function reads a value written by RplWriteValue.
+/// </summary>
+///
+/// <returns> Returns the value. </returns>
+
+long
+RplReadValue()
+{
+  long value = RplReadByte();
+
+  if (value == RPL_ESCAPE)
+  {
+    ReadLong(g_Rpl.hFile, g_Rpl.ioResult, value);
+  }
+
+  return value;
+}   //RplReadValue
+
+/// <summary>
+///   This function initializes the recorder and opens the log file. The
+///   clock of the log starts at the current time.
+/// </summary>
+///
+/// <param name="mode">
+///   Specifies the mode (RPLMODE_OFF, RPLMODE_RECORD or RPLMODE_REPLAY).
+/// </param>
+/// <param name="fileName">
+///   Specifies the log file name.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+RplInit(
+  __in int mode,
+  __in string fileName
+  )
+{
+  int fileSize = RPL_FILE_SIZE;
+
+  g_Rpl.mode = RPLMODE_OFF;
+  g_Rpl.fStarted = false;
+  g_Rpl.fInFrame = false;
+  g_Rpl.fClosePending = false;
+  g_Rpl.fileName = fileName;
+  g_Rpl.cntFrames = 0;
+  g_Rpl.cntBytes = 0;
+  g_Rpl.cntDropped = 0;
+  g_Rpl.timeFrame = nPgmTime;
+  g_Rpl.timePrev = g_Rpl.timeFrame;
+  g_Rpl.timeStart = 0;
+  g_Rpl.flagsFrame = 0;
+  g_Rpl.nEncoders = 0;
+  g_Rpl.nSensors = 0;
+  g_Rpl.iSensor = 0;
+  for (int i = 0; i < MAX_RPL_SENSORS; ++i)
+  {
+    g_Rpl.sensorValues[i] = 0;
+    g_Rpl.sensorPrev[i] = 0;
+  }
+  memset(g_Rpl.joystick, 0, sizeof(g_Rpl.joystick));
+  g_Rpl.timeWork = 0;
+  g_Rpl.timeWorkRec = 0;
+  g_Rpl.timeWorkPlay = 0;
+  g_Rpl.timeMaxRec = 0;
+  g_Rpl.timeMaxPlay = 0;
+
+  if (mode == RPLMODE_RECORD)
+  {
+    Delete(fileName, g_Rpl.ioResult);
+    OpenWrite(g_Rpl.hFile, g_Rpl.ioResult, fileName, fileSize);
+  }
+  else if (mode == RPLMODE_REPLAY)
+  {
+    OpenRead(g_Rpl.hFile, g_Rpl.ioResult, fileName, fileSize);
+  }
+
+  if ((mode != RPLMODE_OFF) && (g_Rpl.ioResult == ioRsltSuccess))
+  {
+    g_Rpl.mode = mode;
+  }
+  else if (mode != RPLMODE_OFF)
+  {
+    debugPrintLine("Replay: cannot open %s", fileName);
+  }
+
+  return;
+}   //RplInit
+
+/// <summary>
+///   This function registers a motor encoder to be recorded. The encoders
+///   must be registered in the same order for record and replay.
+/// </summary>
+///
+/// <param name="idMotor">
+///   Specifies the motor ID.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+RplAddEncoder(
+  __in int idMotor
+  )
+{
+  if (g_Rpl.nEncoders < MAX_RPL_ENCODERS)
+  {
+    g_Rpl.idMotors[g_Rpl.nEncoders] = idMotor;
+    g_Rpl.encValues[g_Rpl.nEncoders] = 0;
+    g_Rpl.encPrev[g_Rpl.nEncoders] = 0;
+    g_Rpl.nEncoders++;
+  }
+
+  return;
+}   //RplAddEncoder
+
+/// <summary>
+///   This function closes the log file. Nothing is recorded or replayed
+///   after this. When recording, a frame in progress is still written and
+///   the log is closed by RplFrameEnd.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+RplClose()
+{
+  if ((g_Rpl.mode == RPLMODE_RECORD) && g_Rpl.fInFrame)
+  {
+    g_Rpl.fClosePending = true;
+  }
+  else if (g_Rpl.mode != RPLMODE_OFF)
+  {
+    Close(g_Rpl.hFile, g_Rpl.ioResult);
+    g_Rpl.mode = RPLMODE_OFF;
+  }
+
+  return;
+}   //RplClose
+
+/// <summary>
+///   This function writes the log header in record mode and checks it in
+///   replay mode. It is called on the first frame so that all the encoders
+///   have been registered by then.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+RplHeader()
+{
+  if (g_Rpl.mode == RPLMODE_RECORD)
+  {
+    WriteShort(g_Rpl.hFile, g_Rpl.ioResult, (short)RPL_MAGIC);
+    WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)RPL_VERSION);
+    WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.nEncoders);
+    g_Rpl.cntBytes += 4;
+  }
+  else
+  {
+    short magic = 0;
+    int version;
+    int nEncoders;
+
+    ReadShort(g_Rpl.hFile, g_Rpl.ioResult, magic);
+    version = RplReadByte();
+    nEncoders = RplReadByte();
+    if ((g_Rpl.ioResult != ioRsltSuccess) || (magic != RPL_MAGIC) ||
+        (version != RPL_VERSION) || (nEncoders != g_Rpl.nEncoders))
+    {
+      debugPrintLine("Replay: bad header in %s", g_Rpl.fileName);
+      RplClose();
+    }
+  }
+
+  return;
+}   //RplHeader
+
+/// <summary>
+///   This function returns the time the control code runs on. While the
+///   log is recorded or replayed, it is the time of the current frame, or
+///   of the last one between frames. Otherwise it is nPgmTime.
+/// </summary>
+///
+/// <returns> Returns the time in msec. </returns>
+
+long
+RplTime()
+{
+  return (g_Rpl.mode != RPLMODE_OFF)? g_Rpl.timeFrame: nPgmTime;
+}   //RplTime
+
+/// <summary>
+///   This function starts a frame. It is called at the beginning of each
+///   loop cycle. In record mode, it samples the encoders and takes the
+///   cycle time as the frame time. In replay mode, it reads the next frame,
+///   sets the encoders to the recorded values and the cycle time to the
+///   recorded frame time. Replay stops when the end of the log is reached.
+/// </summary>
+///
+/// <param name="timeCycle">
+///   Points to the cycle time of the scheduler.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+RplFrameBegin(
+  __inout long &timeCycle
+  )
+{
+  if ((g_Rpl.mode != RPLMODE_OFF) && !g_Rpl.fStarted)
+  {
+    g_Rpl.fStarted = true;
+    RplHeader();
+  }
+  g_Rpl.timeStart = nPgmTime;
+  g_Rpl.iSensor = 0;
+  g_Rpl.fInFrame = true;
+
+  if (g_Rpl.mode == RPLMODE_RECORD)
+  {
+    g_Rpl.timeFrame = timeCycle;
+    g_Rpl.flagsFrame = 0;
+    g_Rpl.nSensors = 0;
+  }
+  else if (g_Rpl.mode == RPLMODE_REPLAY)
+  {
+    g_Rpl.flagsFrame = RplReadByte();
+    g_Rpl.timeWork = RplReadByte() & 0xff;
+    g_Rpl.timeFrame = g_Rpl.timePrev + RplReadValue();
+    if (g_Rpl.flagsFrame & RPLF_JOYSTICK)
+    {
+      int flags = RplReadByte();
+
+      g_Rpl.joystick.UserMode = (flags & RPLF_USERMODE) != 0;
+      g_Rpl.joystick.StopPgm = (flags & RPLF_STOPPGM) != 0;
+      g_Rpl.joystick.joy1_x1 = RplReadByte();
+      g_Rpl.joystick.joy1_y1 = RplReadByte();
+      g_Rpl.joystick.joy1_x2 = RplReadByte();
+      g_Rpl.joystick.joy1_y2 = RplReadByte();
+      ReadShort(g_Rpl.hFile, g_Rpl.ioResult, g_Rpl.joystick.joy1_Buttons);
+      g_Rpl.joystick.joy1_TopHat = RplReadByte();
+      g_Rpl.joystick.joy2_x1 = RplReadByte();
+      g_Rpl.joystick.joy2_y1 = RplReadByte();
+      g_Rpl.joystick.joy2_x2 = RplReadByte();
+      g_Rpl.joystick.joy2_y2 = RplReadByte();
+      ReadShort(g_Rpl.hFile, g_Rpl.ioResult, g_Rpl.joystick.joy2_Buttons);
+      g_Rpl.joystick.joy2_TopHat = RplReadByte();
+    }
+    for (int i = 0; i < g_Rpl.nEncoders; ++i)
+    {
+      g_Rpl.encValues[i] = g_Rpl.encPrev[i] + RplReadValue();
+      g_Rpl.encPrev[i] = g_Rpl.encValues[i];
+    }
+    g_Rpl.nSensors = RplReadByte();
+    for (int i = 0; (i < g_Rpl.nSensors) && (i < MAX_RPL_SENSORS); ++i)
+    {
+      g_Rpl.sensorValues[i] = g_Rpl.sensorPrev[i] + RplReadValue();
+      g_Rpl.sensorPrev[i] = g_Rpl.sensorValues[i];
+    }
+
+    if (g_Rpl.ioResult != ioRsltSuccess)
+    {
+      //
+      // End of the log, go back to the live inputs.
+      //
+      RplClose();
+    }
+    else
+    {
+      for (int i = 0; i < g_Rpl.nEncoders; ++i)
+      {
+        nMotorEncoder[g_Rpl.idMotors[i]] = g_Rpl.encValues[i];
+      }
+      g_Rpl.timePrev = g_Rpl.timeFrame;
+      timeCycle = g_Rpl.timeFrame;
+      g_Rpl.cntFrames++;
+      g_Rpl.timeWorkRec += g_Rpl.timeWork;
+      if (g_Rpl.timeWork > g_Rpl.timeMaxRec)
+      {
+        g_Rpl.timeMaxRec = g_Rpl.timeWork;
+      }
+    }
+  }
+
+  if (g_Rpl.mode == RPLMODE_RECORD)
+  {
+    for (int i = 0; i < g_Rpl.nEncoders; ++i)
+    {
+      g_Rpl.encValues[i] = nMotorEncoder[g_Rpl.idMotors[i]];
+    }
+  }
+
+  return;
+}   //RplFrameBegin
+
+/// <summary>
+///   This function records or replays the joystick. It is called right
+///   after getJoystickSettings.
+/// </summary>
+///
+/// <param name="joy">
+///   Points to the joystick structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+RplJoystick(
+  __inout TJoystick &joy
+  )
+{
+  if (g_Rpl.mode == RPLMODE_RECORD)
+  {
+    if (memcmp(joy, g_Rpl.joystick, sizeof(joy)) != 0)
+    {
+      memcpy(g_Rpl.joystick, joy, sizeof(joy));
+      g_Rpl.flagsFrame |= RPLF_JOYSTICK;
+    }
+  }
+  else if (g_Rpl.mode == RPLMODE_REPLAY)
+  {
+    memcpy(joy, g_Rpl.joystick, sizeof(joy));
+  }
+
+  return;
+}   //RplJoystick
+
+/// <summary>
+///   This function records or replays a sensor reading. Sensor readings
+///   are matched up by the order they are read within a frame.
+/// </summary>
+///
+/// <param name="value">
+///   Specifies the live sensor value.
+/// </param>
+///
+/// <returns> Returns the value the program should use. </returns>
+
+int
+RplSensorValue(
+  __in int value
+  )
+{
+  if (g_Rpl.iSensor < MAX_RPL_SENSORS)
+  {
+    if (g_Rpl.mode == RPLMODE_RECORD)
+    {
+      g_Rpl.sensorValues[g_Rpl.iSensor] = value;
+      g_Rpl.nSensors = g_Rpl.iSensor + 1;
+    }
+    else if ((g_Rpl.mode == RPLMODE_REPLAY) &&
+             (g_Rpl.iSensor < g_Rpl.nSensors))
+    {
+      value = g_Rpl.sensorValues[g_Rpl.iSensor];
+    }
+    g_Rpl.iSensor++;
+  }
+
+  return value;
+}   //RplSensorValue
+
+/// <summary>
+///   This function ends a frame. It is called at the end of each loop cycle.
+///   In record mode, it writes the frame to the log. Frames that don't fit
+///   in the log file any more are dropped.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+RplFrameEnd()
+{
+  int timeWork = BOUND(nPgmTime - g_Rpl.timeStart, 0, 255);
+
+  g_Rpl.fInFrame = false;
+
+  if (g_Rpl.mode == RPLMODE_RECORD)
+  {
+    int sizeMax = 3 + RPL_JOYSTICK_SIZE +
+                  (1 + g_Rpl.nEncoders + g_Rpl.nSensors)*RPL_VALUE_SIZE;
+
+    if (g_Rpl.cntBytes + sizeMax > RPL_FILE_SIZE)
+    {
+      g_Rpl.cntDropped++;
+    }
+    else
+    {
+      WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.flagsFrame);
+      WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)timeWork);
+      g_Rpl.cntBytes += 2;
+      //
+      // The frame time is the change from the last frame in the log, so
+      // it stays right after a dropped frame.
+      //
+      RplWriteValue(g_Rpl.timeFrame - g_Rpl.timePrev);
+      g_Rpl.timePrev = g_Rpl.timeFrame;
+      if (g_Rpl.flagsFrame & RPLF_JOYSTICK)
+      {
+        int flags = 0;
+
+        if (g_Rpl.joystick.UserMode)
+        {
+          flags |= RPLF_USERMODE;
+        }
+        if (g_Rpl.joystick.StopPgm)
+        {
+          flags |= RPLF_STOPPGM;
+        }
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)flags);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy1_x1);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy1_y1);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy1_x2);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy1_y2);
+        WriteShort(g_Rpl.hFile, g_Rpl.ioResult, g_Rpl.joystick.joy1_Buttons);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy1_TopHat);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy2_x1);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy2_y1);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy2_x2);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy2_y2);
+        WriteShort(g_Rpl.hFile, g_Rpl.ioResult, g_Rpl.joystick.joy2_Buttons);
+        WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.joystick.joy2_TopHat);
+        g_Rpl.cntBytes += RPL_JOYSTICK_SIZE;
+      }
+      for (int i = 0; i < g_Rpl.nEncoders; ++i)
+      {
+        //
+        // encValues holds the value of the previous frame until it is
+        // written.
+        //
+        RplWriteValue(g_Rpl.encValues[i] - g_Rpl.encPrev[i]);
+        g_Rpl.encPrev[i] = g_Rpl.encValues[i];
+      }
+      WriteByte(g_Rpl.hFile, g_Rpl.ioResult, (byte)g_Rpl.nSensors);
+      g_Rpl.cntBytes++;
+      for (int i = 0; i < g_Rpl.nSensors; ++i)
+      {
+        RplWriteValue(g_Rpl.sensorValues[i] - g_Rpl.sensorPrev[i]);
+        g_Rpl.sensorPrev[i] = g_Rpl.sensorValues[i];
+      }
+
+      if (g_Rpl.ioResult != ioRsltSuccess)
+      {
+        debugPrintLine("Replay: write error %d", g_Rpl.ioResult);
+        RplClose();
+      }
+      else
+      {
+        g_Rpl.cntFrames++;
+        g_Rpl.timeWorkRec += timeWork;
+        if (timeWork > g_Rpl.timeMaxRec)
+        {
+          g_Rpl.timeMaxRec = timeWork;
+        }
+      }
+    }
+  }
+  else if (g_Rpl.mode == RPLMODE_REPLAY)
+  {
+    g_Rpl.timeWorkPlay += timeWork;
+    if (timeWork > g_Rpl.timeMaxPlay)
+    {
+      g_Rpl.timeMaxPlay = timeWork;
+    }
+  }
+
+  if (g_Rpl.fClosePending)
+  {
+    g_Rpl.fClosePending = false;
+    RplClose();
+  }
+
+  return;
+}   //RplFrameEnd
+
+/// <summary>
+///   This function prints the frame count and the recorded and replayed
+///   loop work times to the debug stream.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+RplDump()
+{
+  debugPrintLine("Replay: %d frames, %d bytes, %d dropped",
+                 g_Rpl.cntFrames, g_Rpl.cntBytes, g_Rpl.cntDropped);
+  if (g_Rpl.cntFrames > 0)
+  {
+    //
+    // The averages are in 1/100 msec.
+    //
+    debugPrintLine("Rec: avg=%d max=%d",
+                   g_Rpl.timeWorkRec*100/g_Rpl.cntFrames, g_Rpl.timeMaxRec);
+    if (g_Rpl.timeWorkPlay > 0)
+    {
+      debugPrintLine("Play: avg=%d max=%d",
+                     g_Rpl.timeWorkPlay*100/g_Rpl.cntFrames,
+                     g_Rpl.timeMaxPlay);
+    }
+  }
+
+  return;
+}   //RplDump
+
+#endif  //ifdef _REPLAY
+
+#endif  //ifndef _REPLAY_H
@@ -0,0 +1,300 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="sched.h" />
+///
+/// <summary>
+///   This module contains the library functions for the fixed-rate task
+///   scheduler.
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   The scheduler keeps an absolute deadline for each loop period so that
+///   the time spent doing work in the loop does not add to the period. It
+///   runs on nPgmTime, not time1[], which is only 16-bit and wraps after
+///   about 32 seconds, and the deadlines are compared on their difference
+///   to the current time. It only uses nPgmTime and wait1Msec, so
+///   sim/schedtest.cpp runs it against a stubbed clock. The tasks are due
+///   on the cycle time, which the input recorder (replay.h) sets to the
+///   recorded one in a replay.
+/// </remarks>
+#endif
+
+#ifndef _SCHED_H
+#define _SCHED_H
+
+#pragma systemFile
+
+#ifdef MOD_ID
+  #undef MOD_ID
+#endif
+#define MOD_ID                  MOD_SCHED
+
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_SCHEDINIT           (FIDBASE_SCHED + 0)
+#define FID_SCHEDADDTASK        (FIDBASE_SCHED + 1)
+#define FID_SCHEDSTART          (FIDBASE_SCHED + 2)
+#define FID_SCHEDTASKDUE        (FIDBASE_SCHED + 3)
+#define FID_SCHEDWAIT           (FIDBASE_SCHED + 4)
+
+#ifdef _TRACE_FUNCNAMES
+string g_SchedFuncNames[5] =
+{
+  "SchedInit",
+  "SchedAddTask",
+  "SchedStart",
+  "SchedTaskDue",
+  "SchedWait"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_SchedFuncNames
+
+//
+// End of generated function IDs.
+//
+
+//
+// Constants.
+//
+#ifndef MAX_SCHED_TASKS
+  #define MAX_SCHED_TASKS       8
+#endif
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int  period;
+  long timeNext;
+  long cntOverruns;
+} SCHED_TASK;
+
+typedef struct
+{
+  int  period;
+  long timeCycle;
+  long timeNext;
+  long cntOverruns;
+  long timeMaxLate;
+  SCHED_TASK Tasks[MAX_SCHED_TASKS];
+} SCHED;
+
+/// <summary>
+///   This function initializes the scheduler.
+/// </summary>
+///
+/// <param name="sched">
+///   Points to the SCHED structure to be initialized.
+/// </param>
+/// <param name="period">
+///   Specifies the loop period in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SchedInit(
+  __out SCHED &sched,
+  __in int period
+  )
+{
+  TFuncId(FID_SCHEDINIT);
+  TEnterMsg(INIT, ("Period=%d", period));
+
+  sched.period = period;
+  sched.timeCycle = 0;
+  sched.timeNext = 0;
+  sched.cntOverruns = 0;
+  sched.timeMaxLate = 0;
+  for (int i = 0; i < MAX_SCHED_TASKS; ++i)
+  {
+    sched.Tasks[i].period = 0;
+    sched.Tasks[i].timeNext = 0;
+    sched.Tasks[i].cntOverruns = 0;
+  }
+
+  TExit(INIT);
+  return;
+}   //SchedInit
+
+/// <summary>
+///   This function registers a periodic task with the scheduler.
+/// </summary>
+///
+/// <param name="sched">
+///   Points to the SCHED structure.
+/// </param>
+/// <param name="idTask">
+///   Specifies the task ID.
+/// </param>
+/// <param name="period">
+///   Specifies the task period in msec. It should be a multiple of the
+///   loop period.
+/// </param>
+///
+/// <returns> Success: Return true. </returns>
+/// <returns> Failure: Return false. </returns>
+
+bool
+SchedAddTask(
+  __inout SCHED &sched,
+  __in int idTask,
+  __in int period
+  )
+{
+  TFuncId(FID_SCHEDADDTASK);
+  TEnterMsg(INIT, ("ID=%d,Period=%d", idTask, period));
+
+  bool fAdded = false;
+
+  if ((idTask >= 0) && (idTask < MAX_SCHED_TASKS) && (period > 0))
+  {
+    sched.Tasks[idTask].period = period;
+    sched.Tasks[idTask].timeNext = 0;
+    sched.Tasks[idTask].cntOverruns = 0;
+    fAdded = true;
+  }
+
+  TExitMsg(INIT, ("fOK=%d", (byte)fAdded));
+  return fAdded;
+}   //SchedAddTask
+
+/// <summary>
+///   This function starts the scheduler. It sets the first deadline one
+///   period from now and makes all tasks due in the first cycle.
+/// </summary>
+///
+/// <param name="sched">
+///   Points to the SCHED structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SchedStart(
+  __inout SCHED &sched
+  )
+{
+  TFuncId(FID_SCHEDSTART);
+  TEnter(API);
+
+  sched.timeCycle = nPgmTime;
+  sched.timeNext = sched.timeCycle + sched.period;
+  for (int i = 0; i < MAX_SCHED_TASKS; ++i)
+  {
+    sched.Tasks[i].timeNext = sched.timeCycle;
+  }
+
+  TExit(API);
+  return;
+}   //SchedStart
+
+/// <summary>
+///   This function determines if a task is due in the current cycle and
+///   advances its deadline if it is.
+/// </summary>
+///
+/// <param name="sched">
+///   Points to the SCHED structure.
+/// </param>
+/// <param name="idTask">
+///   Specifies the task ID.
+/// </param>
+///
+/// <returns> Returns true if the task should run in this cycle. </returns>
+
+bool
+SchedTaskDue(
+  __inout SCHED &sched,
+  __in int idTask
+  )
+{
+  TFuncId(FID_SCHEDTASKDUE);
+  TEnterMsg(HIFREQ, ("ID=%d", idTask));
+
+  bool fDue = false;
+
+  if ((sched.Tasks[idTask].period > 0) &&
+      (sched.timeCycle - sched.Tasks[idTask].timeNext >= 0))
+  {
+    sched.Tasks[idTask].timeNext += sched.Tasks[idTask].period;
+    if (sched.timeCycle - sched.Tasks[idTask].timeNext >= 0)
+    {
+      //
+      // We have missed at least one whole period of this task. Don't try
+      // to catch up, just schedule the next one a period from now.
+      //
+      sched.Tasks[idTask].cntOverruns++;
+      sched.Tasks[idTask].timeNext = sched.timeCycle +
+                                     sched.Tasks[idTask].period;
+    }
+    fDue = true;
+  }
+
+  TExitMsg(HIFREQ, ("fDue=%d", (byte)fDue));
+  return fDue;
+}   //SchedTaskDue
+
+/// <summary>
+///   This function sleeps until the next loop deadline. It only sleeps for
+///   the time left in the period. A cycle that ends right on the deadline is
+///   on time. If the deadline has already passed, it counts an overrun and
+///   does not sleep at all.
+/// </summary>
+///
+/// <param name="sched">
+///   Points to the SCHED structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SchedWait(
+  __inout SCHED &sched
+  )
+{
+  TFuncId(FID_SCHEDWAIT);
+  TEnter(HIFREQ);
+
+  long timeCurr = nPgmTime;
+  long timeLeft = sched.timeNext - timeCurr;
+
+  if (timeLeft >= 0)
+  {
+    wait1Msec(timeLeft);
+  }
+  else
+  {
+    sched.cntOverruns++;
+    if (-timeLeft > sched.timeMaxLate)
+    {
+      sched.timeMaxLate = -timeLeft;
+    }
+    TWarn(("Overrun=%d", -timeLeft));
+  }
+
+  sched.timeCycle = sched.timeNext;
+  sched.timeNext += sched.period;
+  if (timeCurr - sched.timeNext >= 0)
+  {
+    //
+    // We are late by more than a whole period. Drop the missed periods
+    // instead of running a burst of back-to-back cycles.
+    //
+    sched.timeCycle = timeCurr;
+    sched.timeNext = timeCurr + sched.period;
+  }
+
+  TExit(HIFREQ);
+  return;
+}   //SchedWait
+
+#endif  //ifndef _SCHED_H
@@ -0,0 +1,514 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="script.h" />
+///
+/// <summary>
+///   This module contains the library functions to run autonomous scripts
+///   on a state machine.
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   A script is a run of steps in an int array owned by the caller. Each
+///   row of the array is SCRSTEP_SIZE ints: opcode, parameter, wait,
+///   timeout and timeout state. The wait column packs the power with the wait event type and
+///   ID (see SCRWAIT). A row starts one action, and a step is one row or
+///   several rows that run in parallel. The caller unpacks the row at
+///   ScriptStepIndex and passes it to ScriptStep for as long as it returns
+///   true. A script ends with an SCROP_END step. The tables are normally
+///   compiled from a text script by tools/scrc.c.
+///   The power of a drive or turn row is passed to DrivePIDSetDistance or
+///   DrivePIDSetAngle as the motor power limit. With a motion profile
+///   (DriveSetProfile), it also sets the cruise velocity as the percentage
+///   of the velocity limit.
+///   ScriptLibLoad loads a library of scripts from a step file written by
+///   scrc -b into the preallocated buffer of an SCRLIB once at init, so the
+///   program can carry many routines without growing. The load time is
+///   measured and a warning is traced when it is over SCRLIB_LOAD_TARGET.
+///   An opcode with SCROPF_PARALLEL starts its action together with the
+///   next row. The step then waits until all of its actions have sent their
+///   events, or until the first one if the last row has SCROPF_JOIN_ANY.
+///   So the shooter can spin up while the robot is still driving.
+///   Opcodes from SCROP_USER up are passed to the ScriptUserOp function of
+///   the caller. With SCRF_MIRROR, the turn angles are negated so that one
+///   script can be used on both sides of the field.
+///   A step with a timeout goes on to the next step when the timeout
+///   expires, so a stalled step only costs the timeout. The timeout of a
+///   parallel step is the longest one of its rows. A row can also name the
+///   state of a recovery step to go to instead. The state of a step is
+///   SMSTATE_STARTED plus the offset of its first row in the script (see
+///   ScriptState), so the state machine can jump to any step. The drive is
+///   stopped on a timeout so that a stalled move doesn't keep pushing. A
+///   script without timeouts doesn't need SMTimerTask.
+/// </remarks>
+#endif
+
+#ifndef _SCRIPT_H
+#define _SCRIPT_H
+
+#pragma systemFile
+
+#ifdef MOD_ID
+  #undef MOD_ID
+#endif
+#define MOD_ID                  MOD_SCRIPT
+
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_SCRIPTINIT          (FIDBASE_SCRIPT + 0)
+#define FID_SCRIPTSTEP          (FIDBASE_SCRIPT + 1)
+#define FID_SCRIPTLIBLOAD       (FIDBASE_SCRIPT + 2)
+
+#ifdef _TRACE_FUNCNAMES
+string g_ScriptFuncNames[3] =
+{
+  "ScriptInit",
+  "ScriptStep",
+  "ScriptLibLoad"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_ScriptFuncNames
+
+//
+// End of generated function IDs.
+//
+
+//
+// Constants.
+//
+#define SCRSTEP_SIZE            5
+#define SCRCOL_OP               0
+#define SCRCOL_PARAM            1
+#define SCRCOL_WAIT             2
+#define SCRCOL_TIMEOUT          3
+#define SCRCOL_TIMEOUT_STATE    4
+
+#define SCROP_END               0       //stop the state machine
+#define SCROP_DRIVE             1       //drive param inches
+#define SCROP_TURN              2       //turn param degrees, + is right
+#define SCROP_WAIT              3       //only wait for the event or timeout
+#define SCROP_USER              16
+#define SCROP_MASK              0x00ff
+
+#define SCROPF_PARALLEL         0x0100  //run with the next row
+#define SCROPF_JOIN_ANY         0x0200  //step ends on the first event
+
+#define SCRF_USER_MASK          0x00ff
+#define SCRF_MIRROR             0x0001
+
+#ifndef MAX_SCRLIB_ROUTINES
+  #define MAX_SCRLIB_ROUTINES   16
+#endif
+#ifndef SCRLIB_SIZE
+  #define SCRLIB_SIZE           1024    //in ints
+#endif
+#ifndef SCRLIB_LOAD_TARGET
+  #define SCRLIB_LOAD_TARGET    500     //in msec
+#endif
+
+//
+// Step file layout, in little endian shorts unless noted: magic, version
+// (byte), SCRSTEP_SIZE (byte), number of routines and number of ints. Then
+// each routine has its name (SCRLIB_NAME_LEN bytes, zero padded), the
+// index of its first step, its script flags and its estimated time in
+// msec. The ints of the step table come last.
+//
+#define SCRLIB_MAGIC            0x5453  //"ST"
+#define SCRLIB_VERSION          2
+#define SCRLIB_NAME_LEN         16
+
+//
+// Macros.
+//
+#define ScriptStepIndex(s)      (s.iStep)
+#define ScriptState(s)          (SMSTATE_STARTED + \
+                                 (s.iStep - s.iFirst)/SCRSTEP_SIZE)
+//
+// The wait column has the power in the low byte, the event type in bits
+// 8-11 and the event ID in bits 12-14.
+//
+#define SCRWAIT(p,t,i)          (((p) & 0xff) | ((t) << 8) | ((i) << 12))
+#define ScriptPower(w)          ((((w) & 0xff) ^ 0x80) - 0x80)
+#define ScriptEvtType(w)        (((w) >> 8) & 0x0f)
+#define ScriptEvtID(w)          (((w) >> 12) & 0x07)
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int  iFirst;
+  int  iStep;
+  int  timeoutStep;
+  int  stateTimeout;
+  int  flagsScript;
+} SCRIPT;
+
+typedef struct
+{
+  string name;
+  int    iFirst;
+  int    flagsScript;
+  int    timeEst;
+} SCRLIB_ROUTINE;
+
+typedef struct
+{
+  int            nRoutines;
+  int            nInts;
+  long           timeLoad;
+  SCRLIB_ROUTINE Routines[MAX_SCRLIB_ROUTINES];
+  int            Steps[SCRLIB_SIZE];
+} SCRLIB;
+
+//
+// Import function prototypes.
+//
+bool
+ScriptUserOp(
+  __inout SCRIPT &script,
+  __in int opcode,
+  __in int param,
+  __in int power
+  );
+
+/// <summary>
+///   This function initializes a script.
+/// </summary>
+///
+/// <param name="script">
+///   Points to the SCRIPT structure to be initialized.
+/// </param>
+/// <param name="iFirst">
+///   Specifies the index of the first step in the step table.
+/// </param>
+/// <param name="flagsScript">
+///   Specifies the script flags.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+ScriptInit(
+  __out SCRIPT &script,
+  __in int iFirst,
+  __in int flagsScript
+  )
+{
+  TFuncId(FID_SCRIPTINIT);
+  TEnterMsg(INIT, ("First=%d,flags=%x", iFirst, flagsScript));
+
+  script.iFirst = iFirst;
+  script.iStep = iFirst;
+  script.timeoutStep = 0;
+  script.stateTimeout = 0;
+  script.flagsScript = flagsScript & SCRF_USER_MASK;
+
+  TExit(INIT);
+  return;
+}   //ScriptInit
+
+/// <summary>
+///   This function runs a row of a script step. It starts the action of
+///   the row and adds its wait event. On the last row of the step, it sets
+///   up the state machine to advance to the next step when the wait events
+///   come, or to the timeout state when the timeout expires. A step without
+///   wait events or a timeout advances right away. If the state machine
+///   got here on a timeout, the drive is stopped first and the script goes
+///   on from the step of the timeout state.
+/// </summary>
+///
+/// <param name="script">
+///   Points to the SCRIPT structure.
+/// </param>
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="opcode">
+///   Specifies the opcode of the row with the SCROPF flags.
+/// </param>
+/// <param name="param">
+///   Specifies the parameter of the row.
+/// </param>
+/// <param name="power">
+///   Specifies the power of the row.
+/// </param>
+/// <param name="evtType">
+///   Specifies the event type to wait for, EVTTYPE_NONE if none.
+/// </param>
+/// <param name="evtID">
+///   Specifies the event ID to wait for.
+/// </param>
+/// <param name="timeout">
+///   Specifies the row timeout in msec, 0 if none.
+/// </param>
+/// <param name="timeoutState">
+///   Specifies the state to go to on timeout, 0 for the next step.
+/// </param>
+///
+/// <returns> Returns true if the next row is part of the same step, or if
+///           the script jumped to the step of the timeout state. </returns>
+
+bool
+ScriptStep(
+  __inout SCRIPT &script,
+  __inout SM &sm,
+  __inout DRIVE &drive,
+  __in int opcode,
+  __in int param,
+  __in int power,
+  __in int evtType,
+  __in int evtID,
+  __in int timeout,
+  __in int timeoutState
+  )
+{
+  TFuncId(FID_SCRIPTSTEP);
+  TEnterMsg(FUNC, ("Op=%x,Param=%d", opcode, param));
+
+  bool fParallel = false;
+  bool fJump = false;
+  int op = opcode & SCROP_MASK;
+
+  if (IsSMTimedOut(sm))
+  {
+    //
+    // The last step timed out. Stop the drive in case it is stalled and
+    // still pushing, and jump to the step of the timeout state if it isn't
+    // the next one.
+    //
+    sm.flagsSM &= ~SMF_TIMED_OUT;
+    DriveStop(drive);
+    if (ScriptState(script) != sm.currState)
+    {
+      script.iStep = script.iFirst +
+                     (sm.currState - SMSTATE_STARTED)*SCRSTEP_SIZE;
+      script.timeoutStep = 0;
+      script.stateTimeout = 0;
+      fJump = true;
+    }
+  }
+
+  if (fJump)
+  {
+    //
+    // The row is from the old step, have the caller unpack the first row
+    // of the new one.
+    //
+    fParallel = true;
+  }
+  else
+  {
+    SMMarkAction(sm);
+    switch (op)
+    {
+      case SCROP_END:
+        DriveStop(drive);
+        SMStop(sm);
+        break;
+
+      case SCROP_DRIVE:
+        DrivePIDSetDistance(drive, param, power);
+        break;
+
+      case SCROP_TURN:
+        DrivePIDSetAngle(drive,
+                         (script.flagsScript & SCRF_MIRROR)? -param: param,
+                         power);
+        break;
+
+      case SCROP_WAIT:
+        break;
+
+      default:
+        if ((op < SCROP_USER) ||
+            !ScriptUserOp(script, op, param, power))
+        {
+          TErr(("Invalid Op=%d", op));
+        }
+        break;
+    }
+
+    if (op != SCROP_END)
+    {
+      script.iStep += SCRSTEP_SIZE;
+      if (evtType != EVTTYPE_NONE)
+      {
+        SMAddWaitEvent(sm, evtType, evtID, -1);
+      }
+      if (timeout > script.timeoutStep)
+      {
+        script.timeoutStep = timeout;
+      }
+      if (timeoutState != 0)
+      {
+        script.stateTimeout = timeoutState;
+      }
+
+      if (opcode & SCROPF_PARALLEL)
+      {
+        fParallel = true;
+      }
+      else
+      {
+        //
+        // This is the last row of the step, the step timeout covers all
+        // the actions of the step.
+        //
+        if (script.timeoutStep > 0)
+        {
+          SMAddTimeout(sm, script.timeoutStep,
+                       (script.stateTimeout != 0)?
+                       script.stateTimeout: ScriptState(script));
+          script.timeoutStep = 0;
+          script.stateTimeout = 0;
+        }
+
+        if (sm.nWaitEvents > 0)
+        {
+          SMWaitEvents(sm, ScriptState(script),
+                       SMF_CLEAR_EVENTS |
+                       ((opcode & SCROPF_JOIN_ANY)? 0: SMF_WAIT_ALL));
+        }
+        else
+        {
+          sm.currState = ScriptState(script);
+        }
+      }
+    }
+  }
+
+  TExitMsg(FUNC, ("fParallel=%d", (byte)fParallel));
+  return fParallel;
+}   //ScriptStep
+
+/// <summary>
+///   This function loads a library of scripts from a step file. The whole
+///   file is read into the step buffer of the library, so it is done once
+///   at init. The library is left empty if the file is missing, does not
+///   fit or is not a valid step file.
+/// </summary>
+///
+/// <param name="lib">
+///   Points to the SCRLIB structure to be loaded.
+/// </param>
+/// <param name="fileName">
+///   Specifies the name of the step file.
+/// </param>
+///
+/// <returns> Returns true if the library is loaded. </returns>
+
+bool
+ScriptLibLoad(
+  __out SCRLIB &lib,
+  __in string fileName
+  )
+{
+  TFuncId(FID_SCRIPTLIBLOAD);
+  TEnter(INIT);
+
+  bool fLoaded = false;
+  long timeStart = nPgmTime;
+  TFileHandle hFile;
+  TFileIOResult ioResult;
+  int fileSize = 0;
+  short magic = 0;
+  short value = 0;
+  byte version = 0;
+  byte rowSize = 0;
+  byte ch = 0;
+  int nRoutines;
+  int nInts;
+
+  lib.nRoutines = 0;
+  lib.nInts = 0;
+  OpenRead(hFile, ioResult, fileName, fileSize);
+  if (ioResult == ioRsltSuccess)
+  {
+    ReadShort(hFile, ioResult, magic);
+    ReadByte(hFile, ioResult, version);
+    ReadByte(hFile, ioResult, rowSize);
+    ReadShort(hFile, ioResult, value);
+    nRoutines = value;
+    ReadShort(hFile, ioResult, value);
+    nInts = value;
+    if ((ioResult == ioRsltSuccess) && (magic == SCRLIB_MAGIC) &&
+        (version == SCRLIB_VERSION) && (rowSize == SCRSTEP_SIZE) &&
+        (nRoutines > 0) && (nRoutines <= MAX_SCRLIB_ROUTINES) &&
+        (nInts >= SCRSTEP_SIZE) && (nInts <= SCRLIB_SIZE) &&
+        (nInts%SCRSTEP_SIZE == 0))
+    {
+      fLoaded = true;
+      for (int i = 0; i < nRoutines; ++i)
+      {
+        char name[SCRLIB_NAME_LEN + 1];
+
+        for (int j = 0; j < SCRLIB_NAME_LEN; ++j)
+        {
+          ReadByte(hFile, ioResult, ch);
+          name[j] = ch;
+        }
+        name[SCRLIB_NAME_LEN] = 0;
+        StringFromChars(lib.Routines[i].name, name);
+        ReadShort(hFile, ioResult, value);
+        lib.Routines[i].iFirst = value;
+        ReadShort(hFile, ioResult, value);
+        lib.Routines[i].flagsScript = value & SCRF_USER_MASK;
+        ReadShort(hFile, ioResult, value);
+        lib.Routines[i].timeEst = value;
+        if ((lib.Routines[i].iFirst < 0) ||
+            (lib.Routines[i].iFirst >= nInts) ||
+            (lib.Routines[i].iFirst%SCRSTEP_SIZE != 0))
+        {
+          fLoaded = false;
+        }
+      }
+
+      for (int i = 0; i < nInts; ++i)
+      {
+        ReadShort(hFile, ioResult, value);
+        lib.Steps[i] = value;
+      }
+      //
+      // The last routine must end in the table, so no routine can run off
+      // the end of the buffer.
+      //
+      if ((ioResult != ioRsltSuccess) ||
+          ((lib.Steps[nInts - SCRSTEP_SIZE + SCRCOL_OP] & SCROP_MASK) !=
+           SCROP_END))
+      {
+        fLoaded = false;
+      }
+    }
+    Close(hFile, ioResult);
+  }
+
+  lib.timeLoad = nPgmTime - timeStart;
+  if (fLoaded)
+  {
+    lib.nRoutines = nRoutines;
+    lib.nInts = nInts;
+    if (lib.timeLoad > SCRLIB_LOAD_TARGET)
+    {
+      TWarn(("Load took %d msec", lib.timeLoad));
+    }
+  }
+  else
+  {
+    TErr(("Cannot load, size=%d", fileSize));
+  }
+
+  TExitMsg(INIT, ("fLoaded=%d", (byte)fLoaded));
+  return fLoaded;
+}   //ScriptLibLoad
+
+#endif  //ifndef _SCRIPT_H
@@ -22,6 +22,31 @@
 #endif
 #define MOD_ID                  MOD_SENSOR
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_SENSORINIT          (FIDBASE_SENSOR + 0)
+#define FID_SENSORCAL           (FIDBASE_SENSOR + 1)
+#define FID_SENSORTASK          (FIDBASE_SENSOR + 2)
+
+#ifdef _TRACE_FUNCNAMES
+string g_SensorFuncNames[3] =
+{
+  "SensorInit",
+  "SensorCal",
+  "SensorTask"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_SensorFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Constants.
 //
@@ -93,7 +118,7 @@ SensorInit(
   __in int flagsSensor
   )
 {
-  TFuncName("SensorInit");
+  TFuncId(FID_SENSORINIT);
   TEnter(INIT);
 
   sensor.idSensor = idSensor;
@@ -126,7 +151,7 @@ SensorCal(
   __in bool fStart
   )
 {
-  TFuncName("SensorCal");
+  TFuncId(FID_SENSORCAL);
   TEnterMsg(API, ("fStart=%d", (byte)fStart));
 
   if (fStart)
@@ -166,13 +191,16 @@ SensorTask(
   __inout SENSOR &sensor
   )
 {
-  TFuncName("SensorTask");
-  TEnter(HIFREQ);
+  TFuncId(FID_SENSORTASK);
+  TSampleEnter(HIFREQ, TSMPID_SENSOR);
+  PrfEnter(PRFID_SENSOR);
 
 #ifdef HTSMUX_STATUS
   if (sensor.flagsSensor & SENSORF_HTSMUX)
   {
+    PrfFuncBegin(PRFFID_I2C, "I2C");
     sensor.valueSensor = 1023 - HTSMUXreadAnalogue((tMUXSensor)sensor.idSensor);
+    PrfFuncEnd(PRFFID_I2C);
   }
   else
   {
@@ -181,6 +209,10 @@ SensorTask(
 #else
   sensor.valueSensor = SensorRaw[sensor.idSensor];
 #endif
+  //
+  // In replay mode, the recorded reading replaces the live one.
+  //
+  RplSensor(sensor.valueSensor);
   if (sensor.flagsSensor & SENSORF_CALIBRATING)
   {
     //
@@ -227,7 +259,8 @@ SensorTask(
     }
   }
 
-  TExit(HIFREQ);
+  PrfExit(PRFID_SENSOR);
+  TSampleExit(HIFREQ);
   return;
 }   //SensorTask
 
@@ -9,6 +9,29 @@
 ///
 /// <remarks>
 ///   Environment: RobotC for Lego Mindstorms NXT.
+///   The wait events are indexed by bitmasks. Each event type has a mask of
+///   the wait slots waiting for it, and the signaled slots have their bits
+///   set in the signaled mask. So SMSetEvent only compares the slots of the
+///   matching type, and the wait all test is a single compare. With
+///   SMF_WAIT_ALL, the state machine joins several actions started in the
+///   same state and only advances when all of them have sent their events.
+///   The state machine also has a few timers on a timer wheel. Each wheel
+///   slot covers SM_WHEEL_TICK msec and has a mask of the timers expiring
+///   in it, so SMTimerTask only looks at the slots that passed since its
+///   last call. An expired timer sends an EVTTYPE_TIMER event with the
+///   timer ID. SMAddTimeout uses the SMTIMER_TIMEOUT timer to bound a wait
+///   and can send the state machine to a recovery state when it expires.
+///   A timeout transition sets SMF_TIMED_OUT, so the caller can stop the
+///   actions that didn't finish before it runs the timeout state.
+///   The state machine measures the dead time of each transition, from the
+///   event that fulfills the wait to the first action of the new state,
+///   which the caller marks with SMMarkAction. The statistics are reset by
+///   SMStart and kept after the state machine stops, so they can be dumped
+///   at the end of the run.
+///   A state that does not wait leaves the state machine ready, so the
+///   caller can run the next state in the same cycle instead of the next
+///   one. The caller should stop after MAX_SM_CHAIN states in a row so that
+///   a run of states without waits can't hold up the loop.
 /// </remarks>
 #endif
 
@@ -22,22 +45,90 @@
 #endif
 #define MOD_ID                  MOD_SM
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_SMCANCELTIMER       (FIDBASE_SM + 0)
+#define FID_SMSETTIMER          (FIDBASE_SM + 1)
+#define FID_SMCLEARALLEVENTS    (FIDBASE_SM + 2)
+#define FID_SMINIT              (FIDBASE_SM + 3)
+#define FID_SMSTART             (FIDBASE_SM + 4)
+#define FID_SMSTOP              (FIDBASE_SM + 5)
+#define FID_SMADDWAITEVENT      (FIDBASE_SM + 6)
+#define FID_SMADDTIMEOUT        (FIDBASE_SM + 7)
+#define FID_SMWAITEVENTS        (FIDBASE_SM + 8)
+#define FID_SMSETEVENT          (FIDBASE_SM + 9)
+#define FID_SMTIMERTASK         (FIDBASE_SM + 10)
+#define FID_SMMARKACTION        (FIDBASE_SM + 11)
+#define FID_SMLATENCYDUMP       (FIDBASE_SM + 12)
+
+#ifdef _TRACE_FUNCNAMES
+string g_SmFuncNames[13] =
+{
+  "SMCancelTimer",
+  "SMSetTimer",
+  "SMClearAllEvents",
+  "SMInit",
+  "SMStart",
+  "SMStop",
+  "SMAddWaitEvent",
+  "SMAddTimeout",
+  "SMWaitEvents",
+  "SMSetEvent",
+  "SMTimerTask",
+  "SMMarkAction",
+  "SMLatencyDump"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_SmFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Constants.
 //
 #define SMF_READY               0x8000
+#define SMF_TIMED_OUT           0x4000
 #define SMF_MASK                0x00ff
 #define SMF_WAIT_ALL            0x0001
 #define SMF_CLEAR_EVENTS        0x0002
 
+#define SMSTATE_NEXT            -1      //the state given to SMWaitEvents
 #define SMSTATE_DISABLED        0
 #define SMSTATE_STARTED         1
 
 #define EVTTYPE_NONE            0
+#define EVTTYPE_TIMER           (MAX_EVT_TYPES - 1)
+
+#define SMTIMER_TIMEOUT         0
+#define SMTIMER_USER            1
 
 #ifndef MAX_WAIT_EVENTS
-#define MAX_WAIT_EVENTS         4
+#define MAX_WAIT_EVENTS         16
 #endif
+#if MAX_WAIT_EVENTS > 32
+  #error MAX_WAIT_EVENTS must not exceed the bits in the long masks
+#endif
+#ifndef MAX_EVT_TYPES
+#define MAX_EVT_TYPES           8
+#endif
+#ifndef MAX_SM_TIMERS
+#define MAX_SM_TIMERS           4
+#endif
+#if MAX_SM_TIMERS > 16
+  #error MAX_SM_TIMERS must not exceed the bits in the int masks
+#endif
+#ifndef MAX_SM_CHAIN
+#define MAX_SM_CHAIN            4
+#endif
+#define SM_WHEEL_SLOTS          8       //must be a power of 2
+#define SM_WHEEL_TICK           32      //in msec
 
 //
 // Macros.
@@ -45,6 +136,9 @@
 #define IsSMDisabled(s)         (s.currState == SMSTATE_DISABLED)
 #define IsSMEnabled(s)          (s.currState != SMSTATE_DISABLED)
 #define IsSMReady(s)            (s.flagsSM & SMF_READY)
+#define IsSMTimedOut(s)         (s.flagsSM & SMF_TIMED_OUT)
+#define SMEvtBit(i)             ((long)1 << (i))
+#define SMWheelSlot(t)          (int)(((t)/SM_WHEEL_TICK) & (SM_WHEEL_SLOTS - 1))
 
 //
 // Type definitions.
@@ -56,6 +150,7 @@ typedef struct
   int  evtData;
   int  evtParam1;
   int  evtParam2;
+  int  nextState;
   bool fSignaled;
 } WAIT_EVT;
 
@@ -66,11 +161,101 @@ typedef struct
   int  flagsSM;
   bool fClearEvts;
   int  nWaitEvents;
+  long waitMask;
+  long signaledMask;
+  long typeMasks[MAX_EVT_TYPES];
   WAIT_EVT WaitEvents[MAX_WAIT_EVENTS];
+  int  timerMask;
+  int  slotMasks[SM_WHEEL_SLOTS];
+  long timeExpire[MAX_SM_TIMERS];
+  long tickLast;
+  long timeFulfilled;
+  bool fActionPending;
+  long cntTransitions;
+  long timeLatTotal;
+  long timeLatMax;
 } SM;
 
 /// <summary>
-///   This function clears all wait events in the state machine.
+///   This function stops a state machine timer.
+/// </summary>
+///
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+/// <param name="idTimer">
+///   Specifies the timer ID.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SMCancelTimer(
+  __inout SM &sm,
+  __in int idTimer
+  )
+{
+  TFuncId(FID_SMCANCELTIMER);
+  TEnterMsg(API, ("ID=%d", idTimer));
+
+  if ((idTimer >= 0) && (idTimer < MAX_SM_TIMERS) &&
+      (sm.timerMask & (1 << idTimer)))
+  {
+    sm.timerMask &= ~(1 << idTimer);
+    sm.slotMasks[SMWheelSlot(sm.timeExpire[idTimer])] &= ~(1 << idTimer);
+  }
+
+  TExit(API);
+  return;
+}   //SMCancelTimer
+
+/// <summary>
+///   This function starts a state machine timer. The timer sends an
+///   EVTTYPE_TIMER event with the timer ID when it expires. Starting a timer
+///   that is already running restarts it.
+/// </summary>
+///
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+/// <param name="idTimer">
+///   Specifies the timer ID.
+/// </param>
+/// <param name="timeout">
+///   Specifies the time to expire in msec.
+/// </param>
+///
+/// <returns> Success: Return true. </returns>
+/// <returns> Failure: Return false. </returns>
+
+bool
+SMSetTimer(
+  __inout SM &sm,
+  __in int idTimer,
+  __in int timeout
+  )
+{
+  TFuncId(FID_SMSETTIMER);
+  TEnterMsg(API, ("ID=%d,Timeout=%d", idTimer, timeout));
+
+  bool fSet = false;
+
+  if ((idTimer >= 0) && (idTimer < MAX_SM_TIMERS))
+  {
+    SMCancelTimer(sm, idTimer);
+    sm.timeExpire[idTimer] = CtrlTime() + timeout;
+    sm.timerMask |= 1 << idTimer;
+    sm.slotMasks[SMWheelSlot(sm.timeExpire[idTimer])] |= 1 << idTimer;
+    fSet = true;
+  }
+
+  TExitMsg(API, ("fOK=%d", (byte)fSet));
+  return fSet;
+}   //SMSetTimer
+
+/// <summary>
+///   This function clears all wait events in the state machine. Only the
+///   masks are cleared, a wait slot is filled in again when it is added.
 /// </summary>
 ///
 /// <param name="sm">
@@ -84,19 +269,20 @@ SMClearAllEvents(
   __out SM &sm
   )
 {
-  TFuncName("SMClearAllEvents");
+  TFuncId(FID_SMCLEARALLEVENTS);
   TEnter(FUNC);
 
-  for (int i = 0; i < MAX_WAIT_EVENTS; ++i)
+  for (int i = 0; i < MAX_EVT_TYPES; ++i)
   {
-    sm.WaitEvents[i].evtType = EVTTYPE_NONE;
-    sm.WaitEvents[i].evtID = 0;
-    sm.WaitEvents[i].evtData = 0;
-    sm.WaitEvents[i].evtParam1 = 0;
-    sm.WaitEvents[i].evtParam2 = 0;
-    sm.WaitEvents[i].fSignaled = false;
+    sm.typeMasks[i] = 0;
   }
+  sm.waitMask = 0;
+  sm.signaledMask = 0;
   sm.nWaitEvents = 0;
+  //
+  // The timeout only applies to the events that were cleared.
+  //
+  SMCancelTimer(sm, SMTIMER_TIMEOUT);
 
   TExit(FUNC);
   return;
@@ -117,13 +303,19 @@ SMInit(
   __out SM &sm
   )
 {
-  TFuncName("SMInit");
+  TFuncId(FID_SMINIT);
   TEnter(INIT);
 
   sm.currState = SMSTATE_DISABLED;
   sm.nextState = SMSTATE_DISABLED;
   sm.flagsSM = 0;
   sm.fClearEvts = false;
+  sm.timerMask = 0;
+  for (int i = 0; i < SM_WHEEL_SLOTS; ++i)
+  {
+    sm.slotMasks[i] = 0;
+  }
+  sm.tickLast = 0;
   SMClearAllEvents(sm);
 
   TExit(INIT);
@@ -145,7 +337,7 @@ SMStart(
   __out SM &sm
   )
 {
-  TFuncName("SMStart");
+  TFuncId(FID_SMSTART);
   TEnter(API);
 
   if (sm.currState == SMSTATE_DISABLED)
@@ -153,6 +345,11 @@ SMStart(
     sm.currState = SMSTATE_STARTED;
     sm.nextState = SMSTATE_STARTED;
     sm.flagsSM = SMF_READY;
+    sm.tickLast = CtrlTime()/SM_WHEEL_TICK;
+    sm.fActionPending = false;
+    sm.cntTransitions = 0;
+    sm.timeLatTotal = 0;
+    sm.timeLatMax = 0;
   }
 
   TExit(API);
@@ -174,7 +371,7 @@ SMStop(
   __out SM &sm
   )
 {
-  TFuncName("SMStop");
+  TFuncId(FID_SMSTOP);
   TEnter(API);
 
   SMInit(sm);
@@ -211,18 +408,25 @@ SMAddWaitEvent(
   __in int evtData
   )
 {
-  TFuncName("SMAddWaitEvent");
+  TFuncId(FID_SMADDWAITEVENT);
   TEnterMsg(API, ("Type=%x,ID=%x", evtType, evtID));
 
   bool fAdded = false;
 
-  if (sm.nWaitEvents < MAX_WAIT_EVENTS)
+  if ((evtType < 0) || (evtType >= MAX_EVT_TYPES))
+  {
+    TErr(("Invalid Type=%x", evtType));
+  }
+  else if (sm.nWaitEvents < MAX_WAIT_EVENTS)
   {
+    sm.typeMasks[evtType] |= SMEvtBit(sm.nWaitEvents);
+    sm.waitMask |= SMEvtBit(sm.nWaitEvents);
     sm.WaitEvents[sm.nWaitEvents].evtType = evtType;
     sm.WaitEvents[sm.nWaitEvents].evtID = evtID;
     sm.WaitEvents[sm.nWaitEvents].evtData = evtData;
     sm.WaitEvents[sm.nWaitEvents].evtParam1 = 0;
     sm.WaitEvents[sm.nWaitEvents].evtParam2 = 0;
+    sm.WaitEvents[sm.nWaitEvents].nextState = SMSTATE_NEXT;
     sm.WaitEvents[sm.nWaitEvents].fSignaled = false;
     sm.nWaitEvents++;
     fAdded = true;
@@ -233,6 +437,53 @@ SMAddWaitEvent(
   return fAdded;
 }   //SMAddWaitEvent
 
+/// <summary>
+///   This function bounds the wait of the state machine with a timeout. If
+///   the wait is not fulfilled in time, the wait events are cleared and the
+///   state machine goes to the timeout state with SMF_TIMED_OUT set, even
+///   in wait all mode. The timeout is cancelled when the state machine
+///   advances.
+/// </summary>
+///
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+/// <param name="timeout">
+///   Specifies the timeout in msec.
+/// </param>
+/// <param name="timeoutState">
+///   Specifies the state to go to on timeout.
+/// </param>
+///
+/// <returns> Success: Return true. </returns>
+/// <returns> Failure: Return false. </returns>
+
+bool
+SMAddTimeout(
+  __inout SM &sm,
+  __in int timeout,
+  __in int timeoutState
+  )
+{
+  TFuncId(FID_SMADDTIMEOUT);
+  TEnterMsg(API, ("Timeout=%d,State=%d", timeout, timeoutState));
+
+  bool fAdded = SMAddWaitEvent(sm, EVTTYPE_TIMER, SMTIMER_TIMEOUT, -1);
+
+  if (fAdded)
+  {
+    //
+    // The timeout is not part of a wait all join.
+    //
+    sm.waitMask &= ~SMEvtBit(sm.nWaitEvents - 1);
+    sm.WaitEvents[sm.nWaitEvents - 1].nextState = timeoutState;
+    SMSetTimer(sm, SMTIMER_TIMEOUT, timeout);
+  }
+
+  TExitMsg(API, ("fOK=%d", (byte)fAdded));
+  return fAdded;
+}   //SMAddTimeout
+
 /// <summary>
 ///   This function sets the wait event mode and the next state to advance
 ///   to when the wait is fulfilled.
@@ -257,13 +508,13 @@ SMWaitEvents(
   __in int flags
   )
 {
-  TFuncName("SMWaitEvents");
+  TFuncId(FID_SMWAITEVENTS);
   TEnterMsg(API, ("Next=%d,flags=%x", nextState, flags));
 
   if (sm.nWaitEvents > 0)
   {
     sm.nextState = nextState;
-    sm.flagsSM |= flags & SMF_MASK;
+    sm.flagsSM = (sm.flagsSM & ~SMF_MASK) | (flags & SMF_MASK);
     sm.flagsSM &= ~SMF_READY;
     if (sm.flagsSM & SMF_CLEAR_EVENTS)
     {
@@ -317,58 +568,211 @@ SMSetEvent(
   __in int evtParam2
   )
 {
-  TFuncName("SMSetEvent");
+  TFuncId(FID_SMSETEVENT);
   TEnterMsg(EVENT, ("Type=%x,ID=%x", evtType, evtID));
 
-  for (int i = 0; i < sm.nWaitEvents; ++i)
+  long candidates = ((evtType >= 0) && (evtType < MAX_EVT_TYPES))?
+                    sm.typeMasks[evtType] & ~sm.signaledMask: 0;
+
+  //
+  // Only the unsignaled slots waiting for this event type are compared.
+  //
+  for (int i = 0; candidates != 0; ++i)
   {
-    if (!sm.WaitEvents[i].fSignaled &&
-        (sm.WaitEvents[i].evtType == evtType) &&
-        ((sm.WaitEvents[i].evtID == -1) || (sm.WaitEvents[i].evtID == evtID)) &&
-        ((sm.WaitEvents[i].evtData == -1) || (sm.WaitEvents[i].evtData == evtData)))
+    long mask = SMEvtBit(i);
+
+    if (candidates & mask)
     {
-      //
-      // If the all event attributes matched or we don't care some of them,
-      // we mark the event signaled.
-      //
-      TInfo(("Type=%x,ID=%x",
-            sm.WaitEvents[i].evtType, sm.WaitEvents[i].evtID));
-      sm.WaitEvents[i].fSignaled = true;
-      sm.WaitEvents[i].evtID = evtID;
-      sm.WaitEvents[i].evtData = evtData;
-      sm.WaitEvents[i].evtParam1 = evtParam1;
-      sm.WaitEvents[i].evtParam2 = evtParam2;
-
-      bool fAdvanceState = true;
-      if (sm.flagsSM & SMF_WAIT_ALL)
+      candidates &= ~mask;
+      if (((sm.WaitEvents[i].evtID == -1) ||
+           (sm.WaitEvents[i].evtID == evtID)) &&
+          ((sm.WaitEvents[i].evtData == -1) ||
+           (sm.WaitEvents[i].evtData == evtData)))
       {
-        for (int j = 0; j < sm.nWaitEvents; ++j)
+        //
+        // If the all event attributes matched or we don't care some of
+        // them, we mark the event signaled.
+        //
+        TInfo(("Type=%x,ID=%x",
+              sm.WaitEvents[i].evtType, sm.WaitEvents[i].evtID));
+        sm.signaledMask |= mask;
+        sm.WaitEvents[i].fSignaled = true;
+        sm.WaitEvents[i].evtID = evtID;
+        sm.WaitEvents[i].evtData = evtData;
+        sm.WaitEvents[i].evtParam1 = evtParam1;
+        sm.WaitEvents[i].evtParam2 = evtParam2;
+
+        if (sm.WaitEvents[i].nextState != SMSTATE_NEXT)
         {
-          if (!sm.WaitEvents[j].fSignaled)
+          //
+          // This is a timeout, drop the rest of the wait and go to the
+          // timeout state.
+          //
+          TWarn(("Timeout State=%d", sm.currState));
+          sm.currState = sm.WaitEvents[i].nextState;
+          sm.fClearEvts = false;
+          SMClearAllEvents(sm);
+          sm.flagsSM |= SMF_READY | SMF_TIMED_OUT;
+          sm.timeFulfilled = nPgmTime;
+          sm.fActionPending = true;
+        }
+        else if (!(sm.flagsSM & SMF_WAIT_ALL) ||
+                 (sm.signaledMask == sm.waitMask))
+        {
+          TInfo(("AdvanceState"));
+          if (sm.fClearEvts)
+          {
+            sm.fClearEvts = false;
+            SMClearAllEvents(sm);
+          }
+          else
           {
-            fAdvanceState = false;
-            break;
+            SMCancelTimer(sm, SMTIMER_TIMEOUT);
           }
+          sm.currState = sm.nextState;
+          sm.flagsSM = (sm.flagsSM & ~SMF_TIMED_OUT) | SMF_READY;
+          sm.timeFulfilled = nPgmTime;
+          sm.fActionPending = true;
         }
+        break;
       }
+    }
+  }
+
+  TExit(EVENT);
+  return;
+}   //SMSetEvent
 
-      if (fAdvanceState)
+/// <summary>
+///   This function sends the events of the expired timers. It is called
+///   every loop cycle. It only checks the wheel slots from the last call
+///   up to the current one.
+/// </summary>
+///
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SMTimerTask(
+  __inout SM &sm
+  )
+{
+  TFuncId(FID_SMTIMERTASK);
+  TEnter(HIFREQ);
+
+  long timeCurr = CtrlTime();
+  long tickCurr = timeCurr/SM_WHEEL_TICK;
+
+  if (tickCurr - sm.tickLast >= SM_WHEEL_SLOTS)
+  {
+    //
+    // All the slots are due, don't go around more than once.
+    //
+    sm.tickLast = tickCurr - SM_WHEEL_SLOTS + 1;
+  }
+
+  while ((sm.timerMask != 0) && (tickCurr - sm.tickLast >= 0))
+  {
+    int slot = (int)(sm.tickLast & (SM_WHEEL_SLOTS - 1));
+
+    for (int i = 0; (i < MAX_SM_TIMERS) && (sm.slotMasks[slot] != 0); ++i)
+    {
+      //
+      // A timer further than a full turn of the wheel away stays in the
+      // slot until its turn comes.
+      //
+      if ((sm.slotMasks[slot] & (1 << i)) &&
+          (timeCurr - sm.timeExpire[i] >= 0))
       {
-        TInfo(("AdvanceState"));
-        if (sm.fClearEvts)
-        {
-          sm.fClearEvts = false;
-          SMClearAllEvents(sm);
-        }
-        sm.currState = sm.nextState;
-        sm.flagsSM |= SMF_READY;
+        SMCancelTimer(sm, i);
+        SMSetEvent(sm, EVTTYPE_TIMER, i, 0,
+                   (int)(timeCurr - sm.timeExpire[i]), 0);
       }
-      break;
     }
+    sm.tickLast++;
   }
+  //
+  // The current slot may still have timers expiring later in this tick.
+  //
+  sm.tickLast = tickCurr;
 
-  TExit(EVENT);
+  TExit(HIFREQ);
   return;
-}   //SMSetEvent
+}   //SMTimerTask
+
+/// <summary>
+///   This function marks the first action of the state after a transition
+///   and adds the time since the wait was fulfilled to the latency
+///   statistics. The later calls in the same state are ignored.
+/// </summary>
+///
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SMMarkAction(
+  __inout SM &sm
+  )
+{
+  TFuncId(FID_SMMARKACTION);
+  TEnter(FUNC);
+
+  if (sm.fActionPending)
+  {
+    long timeLat = nPgmTime - sm.timeFulfilled;
+
+    sm.fActionPending = false;
+    sm.cntTransitions++;
+    sm.timeLatTotal += timeLat;
+    if (timeLat > sm.timeLatMax)
+    {
+      sm.timeLatMax = timeLat;
+    }
+    TInfo(("State=%d,Lat=%d", sm.currState, timeLat));
+  }
+
+  TExit(FUNC);
+  return;
+}   //SMMarkAction
+
+/// <summary>
+///   This function prints the transition latency statistics of the state
+///   machine to the debug stream.
+/// </summary>
+///
+/// <param name="sm">
+///   Points to the SM structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SMLatencyDump(
+  __in SM &sm
+  )
+{
+  TFuncId(FID_SMLATENCYDUMP);
+  TEnter(UTIL);
+
+  if (sm.cntTransitions > 0)
+  {
+    debugPrintLine("SM latency: msec avg/max/total (n)");
+    debugPrintLine("%d.%02d/%d/%d (%d)",
+                   sm.timeLatTotal/sm.cntTransitions,
+                   sm.timeLatTotal*100/sm.cntTransitions%100,
+                   sm.timeLatMax,
+                   sm.timeLatTotal,
+                   sm.cntTransitions);
+  }
+
+  TExit(UTIL);
+  return;
+}   //SMLatencyDump
 
 #endif  //ifndef _SM_H
@@ -25,10 +25,33 @@
 #define MOD_SENSOR              0x0400
 #define MOD_SM                  0x0800
 #define MOD_LNFOLLOW            0x1000
+#define MOD_SCHED               0x2000
+#define MOD_SCRIPT              0x4000
+#define MOD_EVTBUS              0x8000
 #define MOD_LIB                 (MOD_DRIVE | MOD_BUTTON | MOD_SENSOR | MOD_SM |\
-                                 MOD_LNFOLLOW)
+                                 MOD_LNFOLLOW | MOD_SCHED | MOD_SCRIPT |\
+                                 MOD_EVTBUS)
 #define MOD_MAIN                0x0001
-#define TGenModId(n)            ((MOD_MAIN << (n)) && 0xff)
+#define TGenModId(n)            ((MOD_MAIN << (n)) & 0xff)
+
+//
+// Function ID bases. Each module owns a block of MAX_MOD_FUNCS function
+// IDs. The FID_ constants and the name table of a module are generated
+// into the module by tools/genfid.c.
+//
+#define MAX_MOD_FUNCS           32
+#define FID_ORD_MASK            (MAX_MOD_FUNCS - 1)
+#define FIDBASE_DRIVE           0x0020
+#define FIDBASE_BUTTON          0x0040
+#define FIDBASE_SENSOR          0x0060
+#define FIDBASE_SM              0x0080
+#define FIDBASE_LNFOLLOW        0x00a0
+#define FIDBASE_SCHED           0x00c0
+#define FIDBASE_DRIVERS         0x00e0  //pseudo functions for driver calls
+#define FIDBASE_SCRIPT          0x0100
+#define FIDBASE_EVTBUS          0x0120
+#define FIDBASE_MAIN            0x0140
+#define TGenFidBase(n)          (FIDBASE_MAIN + (n)*MAX_MOD_FUNCS)
 
 #define INIT                    0
 #define API                     1
@@ -43,79 +66,778 @@
 #define INFO                    3
 #define VERBOSE                 4
 
+//
+// Compile-time trace configuration. Each trace level has a mask of the
+// modules that are compiled with trace points of that level. A trace point
+// that is not in the mask of its level is a constant false condition and
+// is compiled out. The trace points that are compiled in can still be
+// turned on and off at runtime with TraceInit. The app can override these
+// before including trace.h.
+//
+#ifndef TRACE_CT_MODULES
+  #define TRACE_CT_MODULES      0xffff
+#endif
+#ifndef TRACE_CT_INIT
+  #define TRACE_CT_INIT         TRACE_CT_MODULES
+#endif
+#ifndef TRACE_CT_API
+  #define TRACE_CT_API          TRACE_CT_MODULES
+#endif
+#ifndef TRACE_CT_EVENT
+  #define TRACE_CT_EVENT        TRACE_CT_MODULES
+#endif
+#ifndef TRACE_CT_FUNC
+  #define TRACE_CT_FUNC         TRACE_CT_MODULES
+#endif
+#ifndef TRACE_CT_UTIL
+  #define TRACE_CT_UTIL         TRACE_CT_MODULES
+#endif
+#ifndef TRACE_CT_HIFREQ
+  #define TRACE_CT_HIFREQ       TRACE_CT_MODULES
+#endif
+#ifndef TRACE_CT_MSGLEVEL
+  #define TRACE_CT_MSGLEVEL     VERBOSE
+#endif
+
+#define TraceCTModules(l)       (((l) == INIT)? TRACE_CT_INIT: \
+                                 ((l) == API)? TRACE_CT_API: \
+                                 ((l) == EVENT)? TRACE_CT_EVENT: \
+                                 ((l) == FUNC)? TRACE_CT_FUNC: \
+                                 ((l) == UTIL)? TRACE_CT_UTIL: \
+                                 TRACE_CT_HIFREQ)
+#define TraceCTOn(m,l)          ((TraceCTModules(l) & (m)) != 0)
+#define MsgCTOn(m,e)            (((TRACE_CT_MODULES & (m)) != 0) && \
+                                 ((e) <= TRACE_CT_MSGLEVEL))
+
+//
+// Binary trace record kinds.
+//
+#define TRACEREC_ENTER          0
+#define TRACEREC_EXIT           1
+#define TRACEREC_MSG            2       //TRACEREC_MSG + message level
+
+#ifndef TRACE_RING_SIZE
+  #define TRACE_RING_SIZE       64
+#endif
+
+//
+// Trace sampling policies.
+//
+#define TSAMPLE_ALL             0       //emit every call
+#define TSAMPLE_EVERY           1       //emit every Nth call
+#define TSAMPLE_RATE            2       //emit at most N calls per second
+#define TSAMPLE_CHANGE          3       //emit only when the args changed
+
+//
+// Trace sample slot IDs.
+//
+#define TSMPID_BUTTON           0
+#define TSMPID_SENSOR           1
+#define TSMPID_DRIVE            2
+#define TSMPID_LNFOLLOW         3
+#define TSMPID_USER             4
+
+#ifndef MAX_TRACE_SAMPLES
+  #define MAX_TRACE_SAMPLES     8
+#endif
+
 //
 // Trace macros.
 //
 #ifdef _DEBUG
-  #define TModEnterMsg(m,l,p)   if (((g_TraceModules & (m)) != 0) && \
-                                    ((l) <= g_TraceLevel)) \
+#ifdef _TRACE_BINARY
+  //
+  // The binary backend only stores the function ID and the line of the
+  // trace point relative to the TFuncId of its function. The host decoder
+  // (tools/tracedec.c) finds the function from its ID and the format string
+  // from the source files, so a log still decodes after edits outside the
+  // functions it went through.
+  //
+  #define _TRACE_FUNCLINES
+  #define TEmitEnterMsg(m,p)    TraceRec(_idFunc, __LINE__ - _lineFunc, \
+                                         TRACEREC_ENTER); \
+                                TraceArgs p
+  #define TEmitEnter(m)         TraceRec(_idFunc, __LINE__ - _lineFunc, \
+                                         TRACEREC_ENTER); \
+                                TraceCommit()
+  #define TEmitExitMsg(m,p)     TraceRec(_idFunc, __LINE__ - _lineFunc, \
+                                         TRACEREC_EXIT); \
+                                TraceArgs p
+  #define TEmitExit(m)          TraceRec(_idFunc, __LINE__ - _lineFunc, \
+                                         TRACEREC_EXIT); \
+                                TraceCommit()
+  #define TEmitMsg(m,e,p)       TraceRec(_idFunc, __LINE__ - _lineFunc, \
+                                         TRACEREC_MSG + (e)); \
+                                TraceArgs p
+  //
+  // Float args are recorded as ints scaled by 10 to the power of the
+  // digits d given to TFloat, and the decoder scales them back by the
+  // precision of their conversion. So a float arg is passed as TFloat(x, d)
+  // to a %w.df conversion.
+  //
+  #define TFloat(x,d)           TraceFloat(x, d)
+  #define TraceInit(m,l,e)      { \
+                                  g_TraceModules = (m); \
+                                  g_TraceLevel = (l); \
+                                  g_MsgLevel = (e); \
+                                  TraceSampleReset(); \
+                                  StartTask(TraceTask); \
+                                }
+#else
+  //
+  // The text backend only keeps the function ID on the stack. The name is
+  // looked up from the name table of the module when a line is printed.
+  //
+  #define _TRACE_FUNCNAMES
+  #define TEmitEnterMsg(m,p)    TracePrefix(TFuncNameOf(_idFunc), true, false); \
+                                debugPrintLine p
+  #define TEmitEnter(m)         TracePrefix(TFuncNameOf(_idFunc), true, true)
+  #define TEmitExitMsg(m,p)     TracePrefix(TFuncNameOf(_idFunc), false, false); \
+                                debugPrintLine p
+  #define TEmitExit(m)          TracePrefix(TFuncNameOf(_idFunc), false, true)
+  #define TEmitMsg(m,e,p)       MsgPrefix(TFuncNameOf(_idFunc), e); \
+                                debugPrintLine p
+  #define TFloat(x,d)           (x)
+  #define TraceInit(m,l,e)      { \
+                                  g_TraceModules = (m); \
+                                  g_TraceLevel = (l); \
+                                  g_MsgLevel = (e); \
+                                  TraceSampleReset(); \
+                                }
+#endif  //ifdef _TRACE_BINARY
+  #define TraceOn(m,l)          (TraceCTOn(m, l) && \
+                                 ((g_TraceModules & (m)) != 0) && \
+                                 ((l) <= g_TraceLevel))
+  #define MsgOn(m,e)            (MsgCTOn(m, e) && \
+                                 ((g_TraceModules & (m)) != 0) && \
+                                 ((e) <= g_MsgLevel))
+  #define TModEnterMsg(m,l,p)   if (TraceOn(m, l)) \
                                 { \
-                                  TracePrefix(_strFuncName, true, false); \
-                                  debugPrintLine p; \
+                                  TEmitEnterMsg(m, p); \
                                 }
-  #define TModEnter(m,l)        if (((g_TraceModules & (m)) != 0) && \
-                                    ((l) <= g_TraceLevel)) \
+  #define TModEnter(m,l)        if (TraceOn(m, l)) \
                                 { \
-                                  TracePrefix(_strFuncName, true, true); \
+                                  TEmitEnter(m); \
                                 }
-  #define TModExitMsg(m,l,p)    if (((g_TraceModules & (m)) != 0) && \
-                                    ((l) <= g_TraceLevel)) \
+  #define TModExitMsg(m,l,p)    if (TraceOn(m, l)) \
                                 { \
-                                  TracePrefix(_strFuncName, false, false); \
-                                  debugPrintLine p; \
+                                  TEmitExitMsg(m, p); \
                                 }
-  #define TModExit(m,l)         if (((g_TraceModules & (m)) != 0) && \
-                                    ((l) <= g_TraceLevel)) \
+  #define TModExit(m,l)         if (TraceOn(m, l)) \
                                 { \
-                                  TracePrefix(_strFuncName, false, true); \
+                                  TEmitExit(m); \
                                 }
-  #define TModMsg(m,e,p)        if (((g_TraceModules & (m)) != 0) && \
-                                    ((e) <= g_MsgLevel)) \
+  #define TModMsg(m,e,p)        if (MsgOn(m, e)) \
                                 { \
-                                  MsgPrefix(_strFuncName, e); \
-                                  debugPrintLine p; \
+                                  TEmitMsg(m, e, p); \
                                 }
-  #define TraceInit(m,l,e)      { \
-                                  g_TraceModules = (m); \
-                                  g_TraceLevel = (l); \
-                                  g_MsgLevel = (e); \
+  //
+  // The sampled variants decide once per call whether the enter is
+  // emitted, and the matching TSampleExit is only emitted with it so the
+  // call tree stays balanced. TSAMPLE_CHANGE compares the enter args.
+  //
+  #define TModSampleEnterMsg(m,l,s,p) \
+                                bool _fSampled = TraceOn(m, l) && \
+                                                 TraceSample(s); \
+                                if (TraceCTOn(m, l) && _fSampled) \
+                                { \
+                                  g_TraceSampleId = (s); \
+                                  _fSampled = TraceSampleArgs p; \
+                                } \
+                                if (TraceCTOn(m, l) && _fSampled) \
+                                { \
+                                  TEmitEnterMsg(m, p); \
+                                }
+  #define TModSampleEnter(m,l,s) \
+                                bool _fSampled = TraceOn(m, l) && \
+                                                 TraceSample(s); \
+                                if (TraceCTOn(m, l) && _fSampled) \
+                                { \
+                                  TEmitEnter(m); \
+                                }
+  #define TModSampleExit(m,l)   if (TraceCTOn(m, l) && _fSampled) \
+                                { \
+                                  TEmitExit(m); \
                                 }
-  #define TFuncName(s)          string _strFuncName = s
-  #define TEnterMsg(l,p)        TModEnterMsg(MOD_ID, l, p)
-  #define TEnter(l)             TModEnter(MOD_ID, l)
-  #define TExitMsg(l,p)         TModExitMsg(MOD_ID, l, p)
-  #define TExit(l)              TModExit(MOD_ID, l)
-  #define TMsg(e,p)             TModMsg(MOD_ID, e, p)
-  #define TFatal(p)             TModMsg(MOD_ID, FATAL, p)
-  #define TErr(p)               TModMsg(MOD_ID, ERR, p)
-  #define TWarn(p)              TModMsg(MOD_ID, WARN, p)
-  #define TInfo(p)              TModMsg(MOD_ID, INFO, p)
-  #define TVerbose(p)           TModMsg(MOD_ID, VERBOSE, p)
 #else
-  #define TModEnterMsg(c,f,p)
-  #define TModEnter(c,f)
-  #define TModExitMsg(c,f,p)
-  #define TModExit(c,f)
-  #define TModMsg(m,e,f,p)
-  #define TInitTrace(m,l,e)
-  #define TFuncName(s)
-  #define TEnterMsg(l,p)
-  #define TEnter(l)
-  #define TExitMsg(l,p)
-  #define TExit(l)
-  #define TMsg(e,p)
-  #define TFatal(p)
-  #define TErr(p)
-  #define TWarn(p)
-  #define TInfo(p)
-  #define TVerbose(p)
+  #define TModEnterMsg(m,l,p)
+  #define TModEnter(m,l)
+  #define TModExitMsg(m,l,p)
+  #define TModExit(m,l)
+  #define TModMsg(m,e,p)
+  #define TModSampleEnterMsg(m,l,s,p)
+  #define TModSampleEnter(m,l,s)
+  #define TModSampleExit(m,l)
+  #define TraceInit(m,l,e)
+  #define TraceSampleInit(s,n,k)
+  #define TraceSampleDump()
 #endif  //ifdef _DEBUG
 
+//
+// The function profiler in profile.h hooks TEnter and TExit. It needs the
+// function ID and the name tables just like the text backend.
+//
+#ifdef _PROFILE_FUNCS
+  #ifndef _TRACE_FUNCNAMES
+    #define _TRACE_FUNCNAMES
+  #endif
+  #define TPrfEnter()           PrfFuncBegin(_idFunc, TFuncNameOf(_idFunc))
+  #define TPrfExit()            PrfFuncEnd(_idFunc)
+#else
+  #define TPrfEnter()
+  #define TPrfExit()
+#endif
+
+#ifdef _TRACE_FUNCLINES
+  #define TFuncId(id)           int _idFunc = (id); int _lineFunc = __LINE__
+#else
+#ifdef _TRACE_FUNCNAMES
+  #define TFuncId(id)           int _idFunc = (id)
+#else
+  #define TFuncId(id)
+#endif
+#endif
+#ifdef _TRACE_FUNCNAMES
+  #define TFuncNameOf(id)       MOD_FUNCNAMES[(id) & FID_ORD_MASK]
+#endif
+
+#define TEnterMsg(l,p)          TPrfEnter(); TModEnterMsg(MOD_ID, l, p)
+#define TEnter(l)               TPrfEnter(); TModEnter(MOD_ID, l)
+#define TExitMsg(l,p)           TModExitMsg(MOD_ID, l, p); TPrfExit()
+#define TExit(l)                TModExit(MOD_ID, l); TPrfExit()
+#define TMsg(e,p)               TModMsg(MOD_ID, e, p)
+#define TFatal(p)               TModMsg(MOD_ID, FATAL, p)
+#define TErr(p)                 TModMsg(MOD_ID, ERR, p)
+#define TWarn(p)                TModMsg(MOD_ID, WARN, p)
+#define TInfo(p)                TModMsg(MOD_ID, INFO, p)
+#define TVerbose(p)             TModMsg(MOD_ID, VERBOSE, p)
+#define TSampleEnterMsg(l,s,p)  TPrfEnter(); TModSampleEnterMsg(MOD_ID, l, s, p)
+#define TSampleEnter(l,s)       TPrfEnter(); TModSampleEnter(MOD_ID, l, s)
+#define TSampleExit(l)          TModSampleExit(MOD_ID, l); TPrfExit()
+
 #ifdef _DEBUG
 
 int g_TraceModules = 0;
 int g_TraceLevel = 0;
 int g_MsgLevel = 0;
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int  policy;
+  int  param;
+  int  cnt;
+  long timeWindow;
+  bool fEmitted;
+  int  nArgs;
+  int  arg0;
+  int  arg1;
+  int  arg2;
+  long cntDropped;
+} TRACE_SAMPLE;
+
+TRACE_SAMPLE g_TraceSamples[MAX_TRACE_SAMPLES];
+int g_TraceSampleId = 0;
+
+/// <summary>
+///   This function resets all trace sample slots to emit every call.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+TraceSampleReset()
+{
+  for (int i = 0; i < MAX_TRACE_SAMPLES; ++i)
+  {
+    g_TraceSamples[i].policy = TSAMPLE_ALL;
+    g_TraceSamples[i].param = 0;
+    g_TraceSamples[i].cnt = 0;
+    g_TraceSamples[i].timeWindow = 0;
+    g_TraceSamples[i].fEmitted = false;
+    g_TraceSamples[i].nArgs = 0;
+    g_TraceSamples[i].cntDropped = 0;
+  }
+
+  return;
+}   //TraceSampleReset
+
+/// <summary>
+///   This function sets the sampling policy of a trace sample slot.
+/// </summary>
+///
+/// <param name="idSample">
+///   Specifies the sample slot ID.
+/// </param>
+/// <param name="policy">
+///   Specifies the TSAMPLE policy. TSAMPLE_CHANGE only applies to
+///   TSampleEnterMsg, plain TSampleEnter emits every call with it.
+/// </param>
+/// <param name="param">
+///   Specifies N for TSAMPLE_EVERY and TSAMPLE_RATE.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+TraceSampleInit(
+  __in int idSample,
+  __in int policy,
+  __in int param
+  )
+{
+  if ((idSample >= 0) && (idSample < MAX_TRACE_SAMPLES))
+  {
+    g_TraceSamples[idSample].policy = policy;
+    g_TraceSamples[idSample].param = (param > 0)? param: 1;
+    g_TraceSamples[idSample].cnt = 0;
+    g_TraceSamples[idSample].timeWindow = nPgmTime;
+    g_TraceSamples[idSample].fEmitted = false;
+    g_TraceSamples[idSample].cntDropped = 0;
+  }
+
+  return;
+}   //TraceSampleInit
+
+/// <summary>
+///   This function applies the call count and rate policies of a sample
+///   slot. It is only called when the trace point is enabled.
+/// </summary>
+///
+/// <param name="idSample">
+///   Specifies the sample slot ID.
+/// </param>
+///
+/// <returns> Returns true if the trace point should be emitted. </returns>
+
+bool
+TraceSample(
+  __in int idSample
+  )
+{
+  bool fEmit = true;
+
+  switch (g_TraceSamples[idSample].policy)
+  {
+    case TSAMPLE_EVERY:
+      fEmit = (g_TraceSamples[idSample].cnt == 0);
+      g_TraceSamples[idSample].cnt++;
+      if (g_TraceSamples[idSample].cnt >= g_TraceSamples[idSample].param)
+      {
+        g_TraceSamples[idSample].cnt = 0;
+      }
+      break;
+
+    case TSAMPLE_RATE:
+      if (nPgmTime - g_TraceSamples[idSample].timeWindow >= 1000)
+      {
+        g_TraceSamples[idSample].timeWindow = nPgmTime;
+        g_TraceSamples[idSample].cnt = 0;
+      }
+      fEmit = (g_TraceSamples[idSample].cnt < g_TraceSamples[idSample].param);
+      if (fEmit)
+      {
+        g_TraceSamples[idSample].cnt++;
+      }
+      break;
+  }
+
+  if (!fEmit)
+  {
+    g_TraceSamples[idSample].cntDropped++;
+  }
+
+  return fEmit;
+}   //TraceSample
+
+/// <summary>
+///   This function applies the TSAMPLE_CHANGE policy of the sample slot
+///   g_TraceSampleId to the args of a trace point.
+/// </summary>
+///
+/// <param name="nArgs">
+///   Specifies the number of args.
+/// </param>
+/// <param name="arg0">
+///   Specifies the first arg.
+/// </param>
+/// <param name="arg1">
+///   Specifies the second arg.
+/// </param>
+/// <param name="arg2">
+///   Specifies the third arg.
+/// </param>
+///
+/// <returns> Returns true if the trace point should be emitted. </returns>
+
+bool
+TraceSampleChanged(
+  __in int nArgs,
+  __in int arg0,
+  __in int arg1,
+  __in int arg2
+  )
+{
+  int i = g_TraceSampleId;
+  bool fEmit = true;
+
+  if (g_TraceSamples[i].policy == TSAMPLE_CHANGE)
+  {
+    fEmit = !g_TraceSamples[i].fEmitted ||
+            (nArgs != g_TraceSamples[i].nArgs) ||
+            (arg0 != g_TraceSamples[i].arg0) ||
+            (arg1 != g_TraceSamples[i].arg1) ||
+            (arg2 != g_TraceSamples[i].arg2);
+    if (fEmit)
+    {
+      g_TraceSamples[i].fEmitted = true;
+      g_TraceSamples[i].nArgs = nArgs;
+      g_TraceSamples[i].arg0 = arg0;
+      g_TraceSamples[i].arg1 = arg1;
+      g_TraceSamples[i].arg2 = arg2;
+    }
+    else
+    {
+      g_TraceSamples[i].cntDropped++;
+    }
+  }
+
+  return fEmit;
+}   //TraceSampleChanged
+
+//
+// The TraceSampleArgs functions take the same parameters as the
+// debugPrintLine calls of the trace points.
+//
+
+bool
+TraceSampleArgs(
+  __in string strFormat
+  )
+{
+  return TraceSampleChanged(0, 0, 0, 0);
+}   //TraceSampleArgs
+
+bool
+TraceSampleArgs(
+  __in string strFormat,
+  __in int arg0
+  )
+{
+  return TraceSampleChanged(1, arg0, 0, 0);
+}   //TraceSampleArgs
+
+bool
+TraceSampleArgs(
+  __in string strFormat,
+  __in int arg0,
+  __in int arg1
+  )
+{
+  return TraceSampleChanged(2, arg0, arg1, 0);
+}   //TraceSampleArgs
+
+bool
+TraceSampleArgs(
+  __in string strFormat,
+  __in int arg0,
+  __in int arg1,
+  __in int arg2
+  )
+{
+  return TraceSampleChanged(3, arg0, arg1, arg2);
+}   //TraceSampleArgs
+
+/// <summary>
+///   This function prints the dropped record count of every sample slot
+///   that has dropped records to the debug stream.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+TraceSampleDump()
+{
+  for (int i = 0; i < MAX_TRACE_SAMPLES; ++i)
+  {
+    if (g_TraceSamples[i].cntDropped > 0)
+    {
+      debugPrintLine("Sample%d: %d dropped", i, g_TraceSamples[i].cntDropped);
+    }
+  }
+
+  return;
+}   //TraceSampleDump
+
+#ifdef _TRACE_BINARY
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int  idFunc;
+  int  line;
+  int  kind;
+  int  nArgs;
+  long time;
+  int  arg0;
+  int  arg1;
+  int  arg2;
+} TRACE_REC;
+
+//
+// The ring buffer has a single producer (the main task) and a single
+// consumer (TraceTask). The producer only advances g_TraceTail and the
+// consumer only advances g_TraceHead. When the ring is full, new records
+// are dropped and counted.
+//
+TRACE_REC g_TraceRing[TRACE_RING_SIZE];
+int  g_TraceHead = 0;
+int  g_TraceTail = 0;
+bool g_fTraceFull = false;
+long g_TraceDropped = 0;
+
+/// <summary>
+///   This function starts a binary trace record. The record is not visible
+///   to the consumer until it is committed.
+/// </summary>
+///
+/// <param name="idFunc">
+///   Specifies the function ID.
+/// </param>
+/// <param name="line">
+///   Specifies the line of the trace point relative to the TFuncId of the
+///   function.
+/// </param>
+/// <param name="kind">
+///   Specifies the TRACEREC kind.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+TraceRec(
+  __in int idFunc,
+  __in int line,
+  __in int kind
+  )
+{
+  int next = (g_TraceTail + 1)%TRACE_RING_SIZE;
+
+  g_fTraceFull = (next == g_TraceHead);
+  if (!g_fTraceFull)
+  {
+    g_TraceRing[g_TraceTail].idFunc = idFunc;
+    g_TraceRing[g_TraceTail].line = line;
+    g_TraceRing[g_TraceTail].kind = kind;
+    g_TraceRing[g_TraceTail].nArgs = 0;
+    g_TraceRing[g_TraceTail].time = nPgmTime;
+  }
+
+  return;
+}   //TraceRec
+
+/// <summary>
+///   This function commits the current binary trace record.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+TraceCommit()
+{
+  if (g_fTraceFull)
+  {
+    g_TraceDropped++;
+  }
+  else
+  {
+    g_TraceTail = (g_TraceTail + 1)%TRACE_RING_SIZE;
+  }
+
+  return;
+}   //TraceCommit
+
+/// <summary>
+///   This function scales a float arg of a trace point to an int. It is
+///   rounded to the nearest step so that 0.21 records as 21 and not 20.
+/// </summary>
+///
+/// <param name="x">
+///   Specifies the float arg.
+/// </param>
+/// <param name="digits">
+///   Specifies the number of digits after the decimal point.
+/// </param>
+///
+/// <returns> Returns the scaled arg. </returns>
+
+int
+TraceFloat(
+  __in float x,
+  __in int digits
+  )
+{
+  for (int i = 0; i < digits; ++i)
+  {
+    x *= 10.0;
+  }
+
+  return (int)((x < 0.0)? x - 0.5: x + 0.5);
+}   //TraceFloat
+
+//
+// The TraceArgs functions take the same parameters as the debugPrintLine
+// calls of the text backend. The format string is not stored since the
+// decoder gets it from the source of the trace point. Only int args can be
+// recorded, so trace points must not pass strings and pass floats through
+// TFloat.
+//
+
+void
+TraceArgs(
+  __in string strFormat
+  )
+{
+  TraceCommit();
+  return;
+}   //TraceArgs
+
+void
+TraceArgs(
+  __in string strFormat,
+  __in int arg0
+  )
+{
+  g_TraceRing[g_TraceTail].arg0 = arg0;
+  g_TraceRing[g_TraceTail].nArgs = 1;
+  TraceCommit();
+  return;
+}   //TraceArgs
+
+void
+TraceArgs(
+  __in string strFormat,
+  __in int arg0,
+  __in int arg1
+  )
+{
+  g_TraceRing[g_TraceTail].arg0 = arg0;
+  g_TraceRing[g_TraceTail].arg1 = arg1;
+  g_TraceRing[g_TraceTail].nArgs = 2;
+  TraceCommit();
+  return;
+}   //TraceArgs
+
+void
+TraceArgs(
+  __in string strFormat,
+  __in int arg0,
+  __in int arg1,
+  __in int arg2
+  )
+{
+  g_TraceRing[g_TraceTail].arg0 = arg0;
+  g_TraceRing[g_TraceTail].arg1 = arg1;
+  g_TraceRing[g_TraceTail].arg2 = arg2;
+  g_TraceRing[g_TraceTail].nArgs = 3;
+  TraceCommit();
+  return;
+}   //TraceArgs
+
+//
+// TraceTask writes each record as '@' followed by eight 16-bit words in
+// hex: idFunc, line, kind and nArgs in the high and low byte, the high and
+// low word of time, and arg0 to arg2. The digits are put together here so
+// the debug stream doesn't parse a format for every record, and the host
+// decoder does all the formatting. The line goes out in two halves since a
+// RobotC string only holds 19 characters.
+//
+#define TRACE_HEX_LEN           18
+char g_TraceHex[TRACE_HEX_LEN + 1];
+
+/// <summary>
+///   This function puts the hex digits of a 16-bit word into g_TraceHex.
+/// </summary>
+///
+/// <param name="pos">
+///   Specifies the position of the first digit.
+/// </param>
+/// <param name="word">
+///   Specifies the word.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+TraceHexWord(
+  __in int pos,
+  __in int word
+  )
+{
+  int digit;
+
+  for (int i = 3; i >= 0; --i)
+  {
+    digit = word & 0x0f;
+    g_TraceHex[pos + i] = (digit < 10)? '0' + digit: 'a' + digit - 10;
+    word = word >> 4;
+  }
+
+  return;
+}   //TraceHexWord
+
+/// <summary>
+///   This task drains the trace ring buffer to the debug stream at low
+///   priority. Each record is written as one line that the host decoder
+///   understands. The drop count is reported whenever it changes.
+/// </summary>
+
+task TraceTask()
+{
+  long dropReported = 0;
+  string strHex;
+
+  nSchedulePriority = kLowPriority;
+  while (true)
+  {
+    while (g_TraceHead != g_TraceTail)
+    {
+      g_TraceHex[0] = '@';
+      TraceHexWord(1, g_TraceRing[g_TraceHead].idFunc);
+      TraceHexWord(5, g_TraceRing[g_TraceHead].line);
+      TraceHexWord(9, (g_TraceRing[g_TraceHead].kind << 8) |
+                      g_TraceRing[g_TraceHead].nArgs);
+      TraceHexWord(13, (int)(g_TraceRing[g_TraceHead].time >> 16));
+      g_TraceHex[17] = 0;
+      StringFromChars(strHex, g_TraceHex);
+      writeDebugStream(strHex);
+      TraceHexWord(0, (int)(g_TraceRing[g_TraceHead].time & 0xffff));
+      TraceHexWord(4, g_TraceRing[g_TraceHead].arg0);
+      TraceHexWord(8, g_TraceRing[g_TraceHead].arg1);
+      TraceHexWord(12, g_TraceRing[g_TraceHead].arg2);
+      g_TraceHex[16] = '\n';
+      g_TraceHex[17] = '\r';
+      g_TraceHex[18] = 0;
+      StringFromChars(strHex, g_TraceHex);
+      writeDebugStream(strHex);
+      g_TraceHead = (g_TraceHead + 1)%TRACE_RING_SIZE;
+    }
+
+    if (g_TraceDropped != dropReported)
+    {
+      dropReported = g_TraceDropped;
+      writeDebugStream("@!%d\n\r", dropReported);
+    }
+    wait1Msec(10);
+  }
+}   //TraceTask
+
+#else
+
 int g_IndentLevel = 0;
 
 /// <summary>
@@ -225,6 +947,8 @@ MsgPrefix(
   return;
 }   //MsgPrefix
 
+#endif  //ifdef _TRACE_BINARY
+
 #endif  //ifdef _DEBUG
 
 #endif  //ifndef _TRACE_H
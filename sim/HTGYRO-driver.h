@@ -0,0 +1,44 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="HTGYRO-driver.h" />
+///
+/// <summary>
+///   This module contains the stand-in for the HiTechnic gyro driver.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   It uses the include guard of drivers/HTGYRO-driver.h, so including it
+///   first keeps the real driver and its I2C code out of the host build.
+///   The gyro reads the turn rate of the drive model, which the simulator
+///   must implement in SimGyroRate. The gyro is calibrated, so
+///   HTGYROstartCal does nothing.
+/// </remarks>
+#endif
+
+#ifndef __HTGYRO_H__
+#define __HTGYRO_H__
+
+//
+// Simulator interface.
+//
+double SimGyroRate();
+
+inline int
+HTGYROreadRot(
+  tSensors link
+  )
+{
+  return (int)floor(SimGyroRate() + 0.5);
+}   //HTGYROreadRot
+
+inline int
+HTGYROstartCal(
+  tSensors link
+  )
+{
+  return 620;
+}   //HTGYROstartCal
+
+#endif  //ifndef __HTGYRO_H__
@@ -0,0 +1,63 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="JoystickDriver.c" />
+///
+/// <summary>
+///   This module contains the stand-in for the RobotC FTC joystick driver.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   The simulator fills in the joystick structure directly, so
+///   getJoystickSettings does nothing and the match starts right away.
+/// </remarks>
+#endif
+
+#ifndef _JOYSTICKDRIVER_C
+#define _JOYSTICKDRIVER_C
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  bool  UserMode;
+  bool  StopPgm;
+  short joy1_x1;
+  short joy1_y1;
+  short joy1_x2;
+  short joy1_y2;
+  short joy1_Buttons;
+  short joy1_TopHat;
+  short joy2_x1;
+  short joy2_y1;
+  short joy2_x2;
+  short joy2_y2;
+  short joy2_Buttons;
+  short joy2_TopHat;
+} TJoystick;
+
+//
+// Global data.
+//
+TJoystick joystick;
+
+inline void
+getJoystickSettings(
+  TJoystick &joy
+  )
+{
+  return;
+}   //getJoystickSettings
+
+inline void
+waitForStart()
+{
+  return;
+}   //waitForStart
+
+#define joy1Btn(n)              ((joystick.joy1_Buttons & (1 << ((n) - 1))) != 0)
+#define joy2Btn(n)              ((joystick.joy2_Buttons & (1 << ((n) - 1))) != 0)
+
+#endif  //ifndef _JOYSTICKDRIVER_C
@@ -0,0 +1,61 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="LEGOLS-driver.h" />
+///
+/// <summary>
+///   This module contains the stand-in for the Lego light sensor driver
+///   and the SMUX support it brings in.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   It uses the include guard of drivers/LEGOLS-driver.h, so including it
+///   first keeps the real driver and its I2C code out of the host build.
+///   The light sensors aren't simulated, so every SMUX port reads as
+///   SensorRaw does when nothing is connected.
+/// </remarks>
+#endif
+
+#ifndef __LEGOLS_H__
+#define __LEGOLS_H__
+
+#define HTSMUX_STATUS           0x21
+
+enum tMUXSensor
+{
+  msensor_S4_1 = 12,
+  msensor_S4_2 = 13,
+  msensor_S4_3 = 14,
+  msensor_S4_4 = 15
+};
+
+inline void
+HTSMUXinit()
+{
+}   //HTSMUXinit
+
+inline bool
+HTSMUXscanPorts(
+  tSensors link
+  )
+{
+  return true;
+}   //HTSMUXscanPorts
+
+inline int
+HTSMUXreadAnalogue(
+  tMUXSensor muxsensor
+  )
+{
+  return 1023;
+}   //HTSMUXreadAnalogue
+
+inline void
+LSsetActive(
+  tMUXSensor muxsensor
+  )
+{
+}   //LSsetActive
+
+#endif  //ifndef __LEGOLS_H__
@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+# Copyright (c) Michael Tsang. All rights reserved.
+#
+# check.sh - builds the host programs of sim/ in each configuration they
+# are used in and runs them. Run it from the root of the repo:
+#   sh sim/check.sh
+# The programs go to $OUT (/tmp/hotshot-check by default). The _DEBUG builds
+# of the simulator compile the trace points of every module in, once with
+# the text and once with the binary trace backend, so a trace point that
+# doesn't compile fails the check even though the robot build doesn't turn
+# it on. Everything is built with warnings as errors, and the step tables
+# in hotshot/autosteps.h must be what tools/scrc.c makes of auto.scr. The
+# check stops at the first failure.
+#
+
+set -e
+
+OUT=${OUT:-/tmp/hotshot-check}
+CXX=${CXX:-g++}
+CC=${CC:-cc}
+WFLAGS="-Wall -Wextra -Wno-unused-parameter -Werror"
+CFLAGS="-std=c99 $WFLAGS"
+CXXFLAGS="-std=c++11 $WFLAGS -Wno-unknown-pragmas -Isim"
+
+mkdir -p "$OUT"
+
+echo "Building the tools"
+for tool in genfid scrc tracedec
+do
+  $CC $CFLAGS -o "$OUT/$tool" tools/$tool.c -lm
+done
+echo "Checking hotshot/autosteps.h against auto.scr"
+"$OUT/scrc" hotshot/auto.scr "$OUT/autosteps.h" > /dev/null
+cmp hotshot/autosteps.h "$OUT/autosteps.h"
+
+echo "Building the simulator"
+$CXX $CXXFLAGS -o "$OUT/hotshot-sim" sim/sim.cpp
+echo "Building the simulator with the text trace (_DEBUG)"
+$CXX $CXXFLAGS -D_DEBUG -o "$OUT/hotshot-sim-debug" sim/sim.cpp
+echo "Building the simulator with the binary trace (_DEBUG _TRACE_BINARY)"
+$CXX $CXXFLAGS -D_DEBUG -D_TRACE_BINARY -o "$OUT/hotshot-sim-binary" sim/sim.cpp
+echo "Building the PID benchmark"
+$CXX $CXXFLAGS -O2 -o "$OUT/pidbench" sim/pidbench.cpp
+echo "Building the scheduler test"
+$CXX $CXXFLAGS -o "$OUT/schedtest" sim/schedtest.cpp
+
+for pos in 0 1 2 3
+do
+  "$OUT/hotshot-sim" -q -p $pos
+  "$OUT/hotshot-sim-debug" -q -p $pos
+  "$OUT/hotshot-sim-binary" -q -p $pos
+done
+"$OUT/pidbench" -n 100000
+"$OUT/schedtest"
+
+echo "All checks passed"
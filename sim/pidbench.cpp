@@ -0,0 +1,481 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="pidbench.cpp" />
+///
+/// <summary>
+///   This module contains the host side equivalence test and benchmark of
+///   the fixed point PID of DriveTask (DRIVEF_FIXED_PID) against the float
+///   PID.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   Build: g++ -std=c++11 -O2 -Wno-unknown-pragmas -Isim -o pidbench sim/pidbench.cpp
+///   Usage: pidbench [-n calls]
+///   Two drives, one with each PID, are put in the same random PID states
+///   for a set of gains in both PID modes, and the motor powers DriveTask
+///   sets are compared. DriveInit rounds the float gains to the fixed
+///   ones, so the powers should agree and both drives should stop on the
+///   same calls. The test fails if the powers ever differ by more than one
+///   or a drive stops alone. The motion profile of the fixed point PID is
+///   compared with the float one at every msec of moves of a few lengths
+///   and powers. The fixed point profile switches phases on whole msec, so
+///   its set points can be up to 2 clicks off, and its feed-forward power
+///   is not compared in the msec of a switch, where kA steps it. The test
+///   fails if the set points differ by more than 2 or the feed-forward
+///   powers by more than one. Then DriveTask is timed with each PID
+///   for the given number of calls. The host has a floating point unit, so the saving on the
+///   NXT, which emulates float in software, is larger than the one
+///   measured here.
+/// </remarks>
+#endif
+
+#include "robotc.h"
+#include <time.h>
+#include "../lib/common.h"
+#include "../lib/trace.h"
+#include "../lib/profile.h"
+#include "../lib/drive.h"
+
+//
+// Constants.
+//
+#define BENCH_DEFAULT_CALLS     10000000L
+#define BENCH_STATES            200000L //PID states compared per gain set
+#define BENCH_MAX_ERR           8000    //in clicks, about 100 inches
+#define BENCH_MAX_DELTA         400     //in clicks per loop
+#define BENCH_VEL_MAX           46.0    //in inches/sec, as hotshot
+#define BENCH_ACC_MAX           300.0   //in inches/sec^2
+#define BENCH_KV                2.1     //in power per inches/sec
+#define BENCH_KA                0.21    //in power per inches/sec^2
+#define BENCH_SETPT_TOL         2       //in clicks
+
+//
+// The encoder clicks per distance and per degree of hotshot/hotshot.h.
+//
+#define BENCH_CLICKS_PER_DISTANCE   (1440.0*16.0/24.0/12.450)
+#define BENCH_CLICKS_PER_DEGREE     (BENCH_CLICKS_PER_DISTANCE*PI*27.08/360)
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  float Kp;
+  float Ki;
+  float Kd;
+} BENCH_GAINS;
+
+//
+// Global data.
+//
+BENCH_GAINS g_BenchGains[] =
+{
+  {0.3, 0.0, 0.0},              //hotshot
+  {0.3, 0.001, 0.5},
+  {1.5, 0.0001, 2.0},
+  {3.0, 0.01, 4.0}
+};
+
+float g_BenchDistances[] = {1.0, 4.0, 12.0, 36.0, 96.0};
+int   g_BenchPowers[] = {20, 50, 100};
+
+DRIVE g_DriveFloat;
+DRIVE g_DriveFixed;
+
+/// <summary>
+///   This function is called by wait1Msec, which the benchmark doesn't
+///   use.
+/// </summary>
+///
+/// <param name="msec">
+///   Specifies the time to advance in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SimStep(
+  int msec
+  )
+{
+  g_SimTime += msec;
+  return;
+}   //SimStep
+
+/// <summary>
+///   This function handles the drive done event, which the benchmark turns
+///   off.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+DriveEvent(
+  DRIVE &drive
+  )
+{
+  return;
+}   //DriveEvent
+
+/// <summary>
+///   This function sets the PID state of a drive as if DriveTask was
+///   about to see the given errors.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="modeDrive">
+///   Specifies the PID drive mode.
+/// </param>
+/// <param name="errLeft">
+///   Specifies the left error.
+/// </param>
+/// <param name="errRight">
+///   Specifies the right error.
+/// </param>
+/// <param name="delta">
+///   Specifies the change of the errors since the last call.
+/// </param>
+/// <param name="integral">
+///   Specifies the sum of the errors before this call.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+BenchSetState(
+  DRIVE &drive,
+  int modeDrive,
+  int errLeft,
+  int errRight,
+  int delta,
+  int integral
+  )
+{
+  nMotorEncoder[drive.motorLeft] = 0;
+  nMotorEncoder[drive.motorRight] = 0;
+  drive.clickTargetLeft = errLeft;
+  drive.clickTargetRight = errRight;
+  drive.errLeftPrev = errLeft - delta;
+  drive.errRightPrev = errRight - delta;
+  drive.errLeftIntegral = integral;
+  drive.errRightIntegral = integral;
+  drive.powerLeft = 100;
+  drive.powerRight = 100;
+  drive.fProfile = false;
+  drive.modeDrive = modeDrive;
+  return;
+}   //BenchSetState
+
+/// <summary>
+///   This function returns a random number in the given range.
+/// </summary>
+///
+/// <param name="low">
+///   Specifies the low end of the range.
+/// </param>
+/// <param name="high">
+///   Specifies the high end of the range.
+/// </param>
+///
+/// <returns> Returns the random number. </returns>
+
+int
+BenchRandom(
+  int low,
+  int high
+  )
+{
+  return low + rand()%(high - low + 1);
+}   //BenchRandom
+
+/// <summary>
+///   This function compares the motor powers of the float and the fixed
+///   point PID over random PID states for all the gains in both PID modes.
+///   The sum of the errors stays in the int range of the NXT.
+/// </summary>
+///
+/// <param name="cntCalls">
+///   Receives the number of DriveTask calls compared.
+/// </param>
+/// <param name="cntDiffs">
+///   Receives the number of calls with different motor powers.
+/// </param>
+/// <param name="cntStops">
+///   Receives the number of calls where only one of the drives stopped
+///   because its power dropped under 2.
+/// </param>
+///
+/// <returns> Returns the largest difference of the motor powers of the
+///           calls where both drives run or both stop. </returns>
+
+int
+BenchCompare(
+  long &cntCalls,
+  long &cntDiffs,
+  long &cntStops
+  )
+{
+  int diffMax = 0;
+  int nGains = sizeof(g_BenchGains)/sizeof(g_BenchGains[0]);
+
+  cntCalls = 0;
+  cntDiffs = 0;
+  cntStops = 0;
+  srand(1);
+  for (int g = 0; g < nGains; ++g)
+  {
+    BENCH_GAINS &gains = g_BenchGains[g];
+
+    DriveInit(g_DriveFloat, motorA, motorB,
+              BENCH_CLICKS_PER_DISTANCE, BENCH_CLICKS_PER_DEGREE,
+              gains.Kp, gains.Ki, gains.Kd, 0);
+    DriveInit(g_DriveFixed, motorC, (TMotors)3,
+              BENCH_CLICKS_PER_DISTANCE, BENCH_CLICKS_PER_DEGREE,
+              gains.Kp, gains.Ki, gains.Kd, DRIVEF_FIXED_PID);
+    for (long i = 0; i < BENCH_STATES; ++i)
+    {
+      bool fAngle = (i & 1) != 0;
+      int modeDrive = fAngle? DRIVEMODE_PID_ANGLE: DRIVEMODE_PID_DISTANCE;
+      int errLeft = BenchRandom(-BENCH_MAX_ERR, BENCH_MAX_ERR);
+      //
+      // The straight line differential of PID_DISTANCE only kicks in when
+      // a power saturates, so a power that is one off can flip it. Keep
+      // the wheels together there to compare the PID alone.
+      //
+      int errRight = fAngle? BenchRandom(-BENCH_MAX_ERR, BENCH_MAX_ERR):
+                             errLeft + BenchRandom(-1, 1);
+      int delta = BenchRandom(-BENCH_MAX_DELTA, BENCH_MAX_DELTA);
+      int integral = BenchRandom(-32767 + BENCH_MAX_ERR,
+                                 32767 - BENCH_MAX_ERR);
+      int diff, diffRight;
+
+      BenchSetState(g_DriveFloat, modeDrive, errLeft, errRight, delta,
+                    integral);
+      BenchSetState(g_DriveFixed, modeDrive, errLeft, errRight, delta,
+                    integral);
+      DriveTask(g_DriveFloat);
+      DriveTask(g_DriveFixed);
+
+      cntCalls++;
+      if (g_DriveFloat.modeDrive != g_DriveFixed.modeDrive)
+      {
+        //
+        // One PID power is 1 and the other is 2, so one drive stops.
+        //
+        cntStops++;
+        continue;
+      }
+      diff = abs(motor[g_DriveFloat.motorLeft] -
+                 motor[g_DriveFixed.motorLeft]);
+      diffRight = abs(motor[g_DriveFloat.motorRight] -
+                      motor[g_DriveFixed.motorRight]);
+      if (diffRight > diff)
+      {
+        diff = diffRight;
+      }
+      if (diff != 0)
+      {
+        cntDiffs++;
+      }
+      if (diff > diffMax)
+      {
+        diffMax = diff;
+      }
+    }
+  }
+
+  return diffMax;
+}   //BenchCompare
+
+/// <summary>
+///   This function compares the set points and the feed-forward powers of
+///   the fixed point motion profile with the float one at every msec of
+///   moves of all the distances and powers. The feed-forward powers are
+///   not compared within a msec of a phase switch.
+/// </summary>
+///
+/// <param name="cntSteps">
+///   Receives the number of msec compared.
+/// </param>
+/// <param name="diffFF">
+///   Receives the largest difference of the feed-forward powers.
+/// </param>
+///
+/// <returns> Returns the largest difference of the set points in clicks.
+/// </returns>
+
+int
+BenchCompareProfile(
+  long &cntSteps,
+  int &diffFF
+  )
+{
+  int diffMax = 0;
+  int nDists = sizeof(g_BenchDistances)/sizeof(g_BenchDistances[0]);
+  int nPowers = sizeof(g_BenchPowers)/sizeof(g_BenchPowers[0]);
+
+  cntSteps = 0;
+  diffFF = 0;
+  DriveInit(g_DriveFloat, motorA, motorB,
+            BENCH_CLICKS_PER_DISTANCE, BENCH_CLICKS_PER_DEGREE,
+            0.3, 0.0, 0.0, 0);
+  DriveInit(g_DriveFixed, motorC, (TMotors)3,
+            BENCH_CLICKS_PER_DISTANCE, BENCH_CLICKS_PER_DEGREE,
+            0.3, 0.0, 0.0, DRIVEF_FIXED_PID);
+  DriveSetProfile(g_DriveFloat, BENCH_VEL_MAX, BENCH_ACC_MAX);
+  DriveSetProfile(g_DriveFixed, BENCH_VEL_MAX, BENCH_ACC_MAX);
+  DriveSetFeedForward(g_DriveFloat, BENCH_KV, BENCH_KA);
+  DriveSetFeedForward(g_DriveFixed, BENCH_KV, BENCH_KA);
+  for (int d = 0; d < nDists; ++d)
+  {
+    for (int p = 0; p < nPowers; ++p)
+    {
+      int clicks;
+      long timeEnd;
+
+      g_DriveFloat.modeDrive = DRIVEMODE_STOPPED;
+      g_DriveFixed.modeDrive = DRIVEMODE_STOPPED;
+      DrivePIDSetDistance(g_DriveFloat, g_BenchDistances[d],
+                          g_BenchPowers[p]);
+      DrivePIDSetDistance(g_DriveFixed, g_BenchDistances[d],
+                          g_BenchPowers[p]);
+      clicks = g_DriveFixed.clickTargetLeft - g_DriveFixed.clickStartLeft;
+      timeEnd = (long)g_DriveFloat.profTimeTotal + 10;
+      for (long t = 0; t <= timeEnd; ++t)
+      {
+        long n = DriveProfileFractionFixed(g_DriveFixed, t)*clicks;
+        int diff = abs((int)(DriveProfileFraction(g_DriveFloat, t)*clicks) -
+                       DRIVE_FIXED_INT(n));
+
+        if (diff > diffMax)
+        {
+          diffMax = diff;
+        }
+        cntSteps++;
+        if ((fabs(t - g_DriveFloat.profTimeAcc) < 1.0) ||
+            (fabs(t - (g_DriveFloat.profTimeTotal -
+                       g_DriveFloat.profTimeAcc)) < 1.0) ||
+            (fabs(t - g_DriveFloat.profTimeTotal) < 1.0))
+        {
+          continue;
+        }
+        n = DriveProfileFeedForwardFixed(g_DriveFixed, t);
+        diff = abs((int)DriveProfileFeedForward(g_DriveFloat, t) -
+                   DRIVE_FIXED_INT(n));
+        if (diff > diffFF)
+        {
+          diffFF = diff;
+        }
+      }
+    }
+  }
+
+  return diffMax;
+}   //BenchCompareProfile
+
+/// <summary>
+///   This function times DriveTask on a drive with the gains of hotshot in
+///   PID_DISTANCE mode with the encoders cycling through the errors of a
+///   move.
+/// </summary>
+///
+/// <param name="drive">
+///   Points to the DRIVE structure.
+/// </param>
+/// <param name="cntCalls">
+///   Specifies the number of calls.
+/// </param>
+/// <param name="flagsDrive">
+///   Specifies the drive flags, which pick the PID.
+/// </param>
+///
+/// <returns> Returns the time per call in nsec. </returns>
+
+double
+BenchTime(
+  DRIVE &drive,
+  long cntCalls,
+  int flagsDrive
+  )
+{
+  BENCH_GAINS &gains = g_BenchGains[0];
+  clock_t clockStart;
+
+  DriveInit(drive, motorA, motorB,
+            BENCH_CLICKS_PER_DISTANCE, BENCH_CLICKS_PER_DEGREE,
+            gains.Kp, gains.Ki, gains.Kd, flagsDrive);
+
+  nMotorEncoder[drive.motorLeft] = 0;
+  nMotorEncoder[drive.motorRight] = 0;
+  DrivePIDSetDistance(drive, 96.0, 100);
+  clockStart = clock();
+  for (long i = 0; i < cntCalls; ++i)
+  {
+    nMotorEncoder[drive.motorLeft] = (i*37)%drive.clickTargetLeft;
+    nMotorEncoder[drive.motorRight] = (i*41)%drive.clickTargetRight;
+    drive.modeDrive = DRIVEMODE_PID_DISTANCE;
+    DriveTask(drive);
+  }
+
+  return (double)(clock() - clockStart)/CLOCKS_PER_SEC*1e9/cntCalls;
+}   //BenchTime
+
+int
+main(
+  int argc,
+  char *argv[]
+  )
+{
+  long cntCalls = BENCH_DEFAULT_CALLS;
+  long cntCompared;
+  long cntDiffs;
+  long cntStops;
+  long cntSteps;
+  int diffMax;
+  int diffSetpt;
+  int diffFF;
+  double timeFloat;
+  double timeFixed;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+    {
+      cntCalls = atol(argv[++i]);
+    }
+    else
+    {
+      fprintf(stderr, "Usage: %s [-n calls]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (cntCalls <= 0)
+  {
+    cntCalls = 1;
+  }
+
+  diffMax = BenchCompare(cntCompared, cntDiffs, cntStops);
+  printf("Equivalence: %ld calls, %ld differ, max difference %d, "
+         "%ld stop at power 1 vs 2\n",
+         cntCompared, cntDiffs, diffMax, cntStops);
+  diffSetpt = BenchCompareProfile(cntSteps, diffFF);
+  printf("Profile: %ld msec, max set point difference %d, "
+         "max feed-forward difference %d\n", cntSteps, diffSetpt, diffFF);
+
+  timeFloat = BenchTime(g_DriveFloat, cntCalls, 0);
+  timeFixed = BenchTime(g_DriveFixed, cntCalls, DRIVEF_FIXED_PID);
+  printf("DriveTask: float %.1f nsec, fixed %.1f nsec, %.1f nsec saved "
+         "per call\n", timeFloat, timeFixed, timeFloat - timeFixed);
+
+  return ((diffMax <= 1) && (cntStops == 0) &&
+          (diffSetpt <= BENCH_SETPT_TOL) &&
+          (diffFF <= 1))? 0: 1;
+}   //main
@@ -0,0 +1,393 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="robotc.h" />
+///
+/// <summary>
+///   This module contains the stand-ins for the RobotC intrinsics used by
+///   lib/ and hotshot/ so that they can be compiled on the host.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   There is only one thread. StartTask does not run the task, so the
+///   display and trace tasks are not simulated. The clock only advances
+///   in wait1Msec, which calls SimStep to run the physics model. The
+///   simulator must implement SimStep.
+/// </remarks>
+#endif
+
+#ifndef _ROBOTC_H
+#define _ROBOTC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cstring>
+#include <math.h>
+
+//
+// Constants.
+//
+#define kNumbOfRealMotors       16
+#define kNumbOfRealSensors      16
+#define kNumbOfTimers           4
+#define kLowPriority            0
+#define kDefaultTaskPriority    7
+#define kHighPriority           255
+#define PI                      3.14159265358979
+#define kExitButton             0
+#define kRightButton            1
+#define kLeftButton             2
+#define kEnterButton            3
+
+//
+// Types.
+//
+typedef unsigned char byte;
+
+//
+// The RobotC string is a fixed 20 character buffer that is copied by
+// value.
+//
+class string
+{
+public:
+  string() { buff[0] = '\0'; }
+  string(const char *s) { Set(s); }
+  string &operator=(const char *s) { Set(s); return *this; }
+  bool operator==(const string &s) const { return strcmp(buff, s.buff) == 0; }
+  bool operator!=(const string &s) const { return strcmp(buff, s.buff) != 0; }
+  const char *c_str() const { return buff; }
+
+private:
+  void Set(const char *s)
+  {
+    strncpy(buff, s, sizeof(buff) - 1);
+    buff[sizeof(buff) - 1] = '\0';
+  }
+
+  char buff[21];
+};
+
+enum TTimers
+{
+  T1, T2, T3, T4
+};
+
+enum TMotorRunState
+{
+  runStateIdle,
+  runStateRunning,
+  runStateHoldPosition
+};
+
+enum TSensors
+{
+  S1, S2, S3, S4
+};
+
+typedef TSensors tSensors;
+
+enum TMotors
+{
+  motorA, motorB, motorC
+};
+
+enum TFileIOResult
+{
+  ioRsltSuccess,
+  ioRsltFileNotFound,
+  ioRsltEndOfFile,
+  ioRsltWriteError
+};
+
+typedef FILE *TFileHandle;
+
+//
+// Simulator interface.
+//
+long g_SimTime = 0;
+void SimStep(int msec);
+
+//
+// nPgmTime reads the simulated clock. time1[] reads it relative to the
+// last time the timer was cleared by assigning to it, and wraps at 16 bits
+// like the timers of the NXT.
+//
+#define nPgmTime                ((long)g_SimTime)
+
+class SimTimers
+{
+public:
+  class Ref
+  {
+  public:
+    Ref(long &base): base(base) {}
+    operator long() const { return (short)(g_SimTime - base); }
+    Ref &operator=(long value) { base = g_SimTime - value; return *this; }
+
+  private:
+    long &base;
+  };
+
+  SimTimers() { memset(bases, 0, sizeof(bases)); }
+  Ref operator[](int idTimer) { return Ref(bases[idTimer]); }
+
+private:
+  long bases[kNumbOfTimers];
+};
+
+//
+// Global data.
+//
+SimTimers      time1;
+int            motor[kNumbOfRealMotors];
+long           nMotorEncoder[kNumbOfRealMotors];
+TMotorRunState nMotorRunState[kNumbOfRealMotors];
+int            SensorRaw[kNumbOfRealSensors];
+int            SensorValue[kNumbOfRealSensors];
+int            nSchedulePriority = kDefaultTaskPriority;
+int            externalBatteryAvg = 13000;
+int            nAvgBatteryLevel = 8000;
+int            nNxtButtonPressed = -1;
+char           g_SimLcd[8][17];
+FILE          *g_SimDebugStream = stdout;
+
+//
+// The formatted output intrinsics take RobotC strings and longs which are
+// converted to what printf expects.
+//
+inline const char *SimArg(const string &s) { return s.c_str(); }
+inline const char *SimArg(const char *s) { return s; }
+inline int SimArg(long n) { return (int)n; }
+inline int SimArg(const SimTimers::Ref &t) { return (int)(long)t; }
+template<typename T> inline T SimArg(T n) { return n; }
+
+#pragma GCC diagnostic ignored "-Wformat-security"
+
+template<typename F, typename... A>
+void
+writeDebugStream(
+  const F &fmt,
+  A... args
+  )
+{
+  fprintf(g_SimDebugStream, SimArg(fmt), SimArg(args)...);
+  return;
+}   //writeDebugStream
+
+template<typename... A>
+void
+debugPrintLine(
+  const char *fmt,
+  A... args
+  )
+{
+  fprintf(g_SimDebugStream, fmt, SimArg(args)...);
+  fputc('\n', g_SimDebugStream);
+  return;
+}   //debugPrintLine
+
+template<typename... A>
+void
+nxtDisplayTextLine(
+  int line,
+  const char *fmt,
+  A... args
+  )
+{
+  if ((line >= 0) && (line < 8))
+  {
+    snprintf(g_SimLcd[line], sizeof(g_SimLcd[line]), fmt, SimArg(args)...);
+  }
+  return;
+}   //nxtDisplayTextLine
+
+inline void
+eraseDisplay()
+{
+  memset(g_SimLcd, 0, sizeof(g_SimLcd));
+  return;
+}   //eraseDisplay
+
+inline void
+StringFromChars(
+  string &s,
+  const char *chars
+  )
+{
+  s = chars;
+  return;
+}   //StringFromChars
+
+//
+// RobotC passes variables to memset, memcpy and memcmp, not pointers.
+//
+template<typename T>
+inline void
+memset(
+  T &var,
+  int value,
+  size_t size
+  )
+{
+  std::memset(&var, value, size);
+  return;
+}   //memset
+
+template<typename T>
+inline void
+memcpy(
+  T &dst,
+  const T &src,
+  size_t size
+  )
+{
+  std::memcpy(&dst, &src, size);
+  return;
+}   //memcpy
+
+template<typename T>
+inline int
+memcmp(
+  const T &var1,
+  const T &var2,
+  size_t size
+  )
+{
+  return std::memcmp(&var1, &var2, size);
+}   //memcmp
+
+//
+// The NXT file system maps to files in the current directory. Shorts and
+// longs are little endian as on the NXT.
+//
+inline void
+OpenWrite(
+  TFileHandle &hFile,
+  TFileIOResult &ioResult,
+  const string &fileName,
+  int &fileSize
+  )
+{
+  hFile = fopen(fileName.c_str(), "wb");
+  ioResult = (hFile != NULL)? ioRsltSuccess: ioRsltWriteError;
+  return;
+}   //OpenWrite
+
+inline void
+OpenRead(
+  TFileHandle &hFile,
+  TFileIOResult &ioResult,
+  const string &fileName,
+  int &fileSize
+  )
+{
+  hFile = fopen(fileName.c_str(), "rb");
+  ioResult = (hFile != NULL)? ioRsltSuccess: ioRsltFileNotFound;
+  if (hFile != NULL)
+  {
+    fseek(hFile, 0, SEEK_END);
+    fileSize = (int)ftell(hFile);
+    fseek(hFile, 0, SEEK_SET);
+  }
+  return;
+}   //OpenRead
+
+inline void
+Close(
+  TFileHandle &hFile,
+  TFileIOResult &ioResult
+  )
+{
+  ioResult = (fclose(hFile) == 0)? ioRsltSuccess: ioRsltWriteError;
+  hFile = NULL;
+  return;
+}   //Close
+
+inline void
+Delete(
+  const string &fileName,
+  TFileIOResult &ioResult
+  )
+{
+  ioResult = (remove(fileName.c_str()) == 0)? ioRsltSuccess:
+                                              ioRsltFileNotFound;
+  return;
+}   //Delete
+
+inline void
+SimWrite(
+  TFileHandle hFile,
+  TFileIOResult &ioResult,
+  unsigned long data,
+  int size
+  )
+{
+  for (int i = 0; i < size; ++i)
+  {
+    if (fputc((int)((data >> (8*i)) & 0xff), hFile) == EOF)
+    {
+      ioResult = ioRsltWriteError;
+    }
+  }
+  return;
+}   //SimWrite
+
+inline unsigned long
+SimRead(
+  TFileHandle hFile,
+  TFileIOResult &ioResult,
+  int size
+  )
+{
+  unsigned long data = 0;
+
+  for (int i = 0; i < size; ++i)
+  {
+    int c = fgetc(hFile);
+
+    if (c == EOF)
+    {
+      ioResult = ioRsltEndOfFile;
+      c = 0;
+    }
+    data |= (unsigned long)c << (8*i);
+  }
+  return data;
+}   //SimRead
+
+inline void WriteByte(TFileHandle h, TFileIOResult &r, byte data) { SimWrite(h, r, data, 1); }
+inline void WriteShort(TFileHandle h, TFileIOResult &r, short data) { SimWrite(h, r, (unsigned short)data, 2); }
+inline void WriteLong(TFileHandle h, TFileIOResult &r, long data) { SimWrite(h, r, (unsigned int)data, 4); }
+inline void ReadByte(TFileHandle h, TFileIOResult &r, byte &data) { data = (byte)SimRead(h, r, 1); }
+inline void ReadShort(TFileHandle h, TFileIOResult &r, short &data) { data = (short)SimRead(h, r, 2); }
+inline void ReadLong(TFileHandle h, TFileIOResult &r, long &data) { data = (int)SimRead(h, r, 4); }
+
+inline void
+wait1Msec(
+  long msec
+  )
+{
+  SimStep((int)msec);
+  return;
+}   //wait1Msec
+
+inline void
+wait10Msec(
+  long msec
+  )
+{
+  SimStep((int)msec*10);
+  return;
+}   //wait10Msec
+
+//
+// Tasks are not run by the simulator.
+//
+#define task                    void
+#define StartTask(t)
+#define StopTask(t)
+
+#endif  //ifndef _ROBOTC_H
@@ -0,0 +1,256 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="schedtest.cpp" />
+///
+/// <summary>
+///   This module contains the host side test of the fixed-rate scheduler
+///   (lib/sched.h) against a stubbed clock.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   Build: g++ -std=c++11 -Wno-unknown-pragmas -Isim -o schedtest sim/schedtest.cpp
+///   Usage: schedtest
+///   The loop of the robot is run for a few seconds of stub clock, starting
+///   just before time1[] of the NXT wraps at 16 bits. The loop does a few
+///   msec of work each cycle, except for one cycle that overruns by less
+///   than a period, one that ends right on its deadline and one that
+///   overruns by more than two periods. The test checks that the cycles
+///   start on the period grid across the wrap, that the loop catches up to
+///   the grid after the short overrun, that the cycle on its deadline is
+///   not an overrun, that it drops the missed periods after the long one
+///   instead of running a burst, and that the overruns are counted. It
+///   fails if any check fails.
+/// </remarks>
+#endif
+
+#include "robotc.h"
+#include "../lib/common.h"
+#include "../lib/trace.h"
+#include "../lib/sched.h"
+
+//
+// Constants.
+//
+#define TEST_TIME_START         32000L  //in msec, time1[] wraps at 32768
+#define TEST_PERIOD             10      //in msec
+#define TEST_CYCLES             300
+#define TEST_WORK               3       //in msec
+#define TEST_CYCLE_SHORT        100     //overruns by less than a period
+#define TEST_WORK_SHORT         15
+#define TEST_CYCLE_EXACT        150     //ends right on its deadline
+#define TEST_WORK_EXACT         TEST_PERIOD
+#define TEST_CYCLE_LONG         200     //overruns by more than two periods
+#define TEST_WORK_LONG          35
+#define TEST_TASK_FAST          0
+#define TEST_TASK_SLOW          1
+
+//
+// Global data.
+//
+SCHED g_Sched;
+long  g_TimeStart[TEST_CYCLES];
+int   g_cntFailed = 0;
+
+/// <summary>
+///   This function is called by wait1Msec. It advances the stub clock.
+/// </summary>
+///
+/// <param name="msec">
+///   Specifies the time to advance in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SimStep(
+  int msec
+  )
+{
+  g_SimTime += msec;
+  return;
+}   //SimStep
+
+/// <summary>
+///   This function reports the result of a check.
+/// </summary>
+///
+/// <param name="fPassed">
+///   Specifies whether the check passed.
+/// </param>
+/// <param name="name">
+///   Specifies what was checked.
+/// </param>
+/// <param name="actual">
+///   Specifies the value the check saw.
+/// </param>
+/// <param name="expected">
+///   Specifies the value the check wanted.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+TestCheck(
+  bool fPassed,
+  const char *name,
+  long actual,
+  long expected
+  )
+{
+  printf("%s: %s (%ld, expected %ld)\n",
+         fPassed? "PASS": "FAIL", name, actual, expected);
+  if (!fPassed)
+  {
+    g_cntFailed++;
+  }
+
+  return;
+}   //TestCheck
+
+/// <summary>
+///   This function returns the msec of work the loop does in a cycle.
+/// </summary>
+///
+/// <param name="cycle">
+///   Specifies the cycle.
+/// </param>
+///
+/// <returns> Returns the work time in msec. </returns>
+
+int
+TestWork(
+  int cycle
+  )
+{
+  return (cycle == TEST_CYCLE_SHORT)? TEST_WORK_SHORT:
+         (cycle == TEST_CYCLE_EXACT)? TEST_WORK_EXACT:
+         (cycle == TEST_CYCLE_LONG)? TEST_WORK_LONG: TEST_WORK;
+}   //TestWork
+
+/// <summary>
+///   This function checks that a run of cycles starts exactly one period
+///   apart from the given start time on.
+/// </summary>
+///
+/// <param name="name">
+///   Specifies what is checked.
+/// </param>
+/// <param name="first">
+///   Specifies the first cycle.
+/// </param>
+/// <param name="last">
+///   Specifies the cycle after the last one.
+/// </param>
+/// <param name="timeFirst">
+///   Specifies when the first cycle should start.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+TestGrid(
+  const char *name,
+  int first,
+  int last,
+  long timeFirst
+  )
+{
+  int cycle = first;
+
+  while ((cycle < last) &&
+         (g_TimeStart[cycle] == timeFirst + (long)(cycle - first)*TEST_PERIOD))
+  {
+    cycle++;
+  }
+  TestCheck(cycle == last, name, g_TimeStart[cycle < last? cycle: last - 1],
+            timeFirst + (long)((cycle < last? cycle: last - 1) - first)*
+                        TEST_PERIOD);
+
+  return;
+}   //TestGrid
+
+int
+main(
+  int argc,
+  char *argv[]
+  )
+{
+  int cntFast = 0;
+  int cntSlow = 0;
+  bool fWrapped = false;
+  long timeLong;
+
+  if (argc > 1)
+  {
+    fprintf(stderr, "Usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  g_SimTime = TEST_TIME_START;
+  SchedInit(g_Sched, TEST_PERIOD);
+  SchedAddTask(g_Sched, TEST_TASK_FAST, TEST_PERIOD);
+  SchedAddTask(g_Sched, TEST_TASK_SLOW, 2*TEST_PERIOD);
+  SchedStart(g_Sched);
+  for (int cycle = 0; cycle < TEST_CYCLES; ++cycle)
+  {
+    g_TimeStart[cycle] = nPgmTime;
+    fWrapped = fWrapped || (time1[T1] < 0);
+    if (SchedTaskDue(g_Sched, TEST_TASK_FAST))
+    {
+      cntFast++;
+    }
+    if ((cycle < TEST_CYCLE_SHORT) && SchedTaskDue(g_Sched, TEST_TASK_SLOW))
+    {
+      cntSlow++;
+    }
+    wait1Msec(TestWork(cycle));
+    SchedWait(g_Sched);
+  }
+
+  //
+  // The stub time1[] must have wrapped for the run to mean anything.
+  //
+  TestCheck(fWrapped, "time1[] wrapped during the run", time1[T1], -1);
+  //
+  // Up to the short overrun the cycles run on the grid of the start time,
+  // through the wrap.
+  //
+  TestGrid("cycles on the period grid through the wrap",
+           0, TEST_CYCLE_SHORT + 1, TEST_TIME_START);
+  TestCheck(cntSlow == TEST_CYCLE_SHORT/2, "slow task runs every other cycle",
+            cntSlow, TEST_CYCLE_SHORT/2);
+  //
+  // The cycle after the short overrun starts late, the one after that is
+  // back on the grid. The cycle that ends on its deadline doesn't move the
+  // grid.
+  //
+  TestCheck(g_TimeStart[TEST_CYCLE_SHORT + 1] ==
+            g_TimeStart[TEST_CYCLE_SHORT] + TEST_WORK_SHORT,
+            "cycle after the short overrun starts without a wait",
+            g_TimeStart[TEST_CYCLE_SHORT + 1] - g_TimeStart[TEST_CYCLE_SHORT],
+            TEST_WORK_SHORT);
+  TestGrid("cycles catch up to the grid after the short overrun",
+           TEST_CYCLE_SHORT + 2, TEST_CYCLE_LONG + 1,
+           TEST_TIME_START + (long)(TEST_CYCLE_SHORT + 2)*TEST_PERIOD);
+  //
+  // After the long overrun, the missed periods are dropped: the loop goes
+  // on one period at a time on a new grid instead of a burst of cycles.
+  //
+  timeLong = g_TimeStart[TEST_CYCLE_LONG] + TEST_WORK_LONG;
+  TestGrid("cycles drop the missed periods after the long overrun",
+           TEST_CYCLE_LONG + 1, TEST_CYCLES, timeLong);
+  TestCheck(g_Sched.cntOverruns == 2, "loop overruns", g_Sched.cntOverruns, 2);
+  TestCheck(g_Sched.timeMaxLate == TEST_WORK_LONG - TEST_PERIOD,
+            "loop max late", g_Sched.timeMaxLate, TEST_WORK_LONG - TEST_PERIOD);
+  TestCheck(g_Sched.Tasks[TEST_TASK_FAST].cntOverruns == 1,
+            "fast task overruns", g_Sched.Tasks[TEST_TASK_FAST].cntOverruns, 1);
+  TestCheck(cntFast == TEST_CYCLES, "fast task runs every cycle",
+            cntFast, TEST_CYCLES);
+
+  printf("%s: %d checks failed\n", (g_cntFailed == 0)? "PASS": "FAIL",
+         g_cntFailed);
+
+  return (g_cntFailed == 0)? 0: 1;
+}   //main
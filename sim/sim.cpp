@@ -0,0 +1,471 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="sim.cpp" />
+///
+/// <summary>
+///   This module contains the host side simulator for the autonomous
+///   program (hotshot/auto.c) with a differential drive model of the
+///   robot running base.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, C++.
+///   Build: g++ -std=c++11 -Wno-unknown-pragmas -Isim -o hotshot-sim sim/sim.cpp
+///   Add -D_DEBUG to compile the trace points in. sim/check.sh builds both
+///   and runs all the routines.
+///   Usage: hotshot-sim [-p startPos] [-t timeout] [-s stallTime]
+///                     [-g traction] [-b time,angle] [-n] [-u] [-f]
+///                     [-c] [-y] [-q] [-a stepFile] [-r|-R logFile]
+///   The program runs unmodified against sim/robotc.h on a simulated clock.
+///   The clock only advances when the program waits, so the simulation runs
+///   as fast as the host allows. The run ends when the autonomous state
+///   machine is done or the timeout (in sec) expires, and the completion
+///   time and the final pose of the robot are reported. The pose starts at
+///   (0, 0) facing along +x, and the heading is counterclockwise in degrees.
+///   -s stalls the wheels from stallTime (in sec) on, as if the robot was
+///   pushed against a wall.
+///   -g limits the traction of the wheels to the given acceleration (in
+///   inches/sec^2). A wheel that speeds up or slows down faster than that
+///   slips: the encoder follows the motor but the robot does not, and the
+///   slip is reported. By default the wheels never slip.
+///   -b bumps the robot at the given time (in sec) by the given angle (in
+///   degrees, + is right) over 100 msec, as if it was hit by another
+///   robot. The wheels turn with the robot, so the encoders don't see the
+///   bump but the gyro does.
+///   -u drives without the motion profile of the PID drive (DRIVE_PROFILE),
+///   to compare the run times and the slip.
+///   -f drives the motion profile without the feed-forward
+///   (DRIVE_FEEDFORWARD), to compare the overshoot and the run times. The
+///   overshoot is the farthest a wheel went past the target of a profiled
+///   move while the move was running.
+///   -c ends the PID drive moves on the PID power only, without the
+///   completion tolerance (DRIVE_TOLERANCE), to compare the run times.
+///   -y keeps the robot straight on the encoders only, without the gyro
+///   heading hold (DRIVE_HEADING_HOLD), to compare the final heading.
+///   -n turns off the run to completion of the autonomous state machine at
+///   the end of the output tasks (AUTO_CHAIN), to compare the run times.
+///   -q discards the debug stream of the program.
+///   -a loads the autonomous routines from stepFile (see tools/scrc.c) in
+///   place of the ones compiled into the program, and -p picks the routine.
+///   The match starts right away, so the routine menu ends on -p.
+///   -r records the inputs of the run to logFile and -R replays them from
+///   logFile (see lib/replay.h). A replayed run should end with the same
+///   completion time and pose as the recorded one.
+/// </remarks>
+#endif
+
+#include "robotc.h"
+#include <time.h>
+
+//
+// Motor and sensor names from the #pragma config of hotshot/auto.c, with
+// the light sensors on the SMUX on S4 and the gyro on S2.
+//
+#define motorD                  ((TMotors)3)
+#define motorE                  ((TMotors)4)
+#define motorF                  ((TMotors)5)
+#define motorG                  ((TMotors)6)
+#define HTSmux                  S4
+#define USE_HTSMUX
+#define GYRO_SENSOR             S2
+
+//
+// The input recorder is always compiled in, the mode and the log file are
+// set on the command line and so is the state machine chaining.
+//
+#define _REPLAY
+#define RPL_MODE                g_SimRplMode
+#define RPL_FILE_NAME           g_SimRplFile
+#define AUTO_CHAIN              g_SimChain
+#define AUTO_FILE_NAME          g_SimAutoFile
+#define DRIVE_PROFILE           g_SimProfile
+#define DRIVE_TOLERANCE         g_SimTolerance
+#define DRIVE_FEEDFORWARD       g_SimFeedForward
+#define DRIVE_HEADING_HOLD      g_SimHeadingHold
+
+int    g_SimRplMode = 0;
+string g_SimRplFile;
+bool   g_SimChain = true;
+string g_SimAutoFile;
+bool   g_SimProfile = true;
+bool   g_SimTolerance = true;
+bool   g_SimFeedForward = true;
+bool   g_SimHeadingHold = true;
+
+#include "LEGOLS-driver.h"
+#include "HTGYRO-driver.h"
+#define main                    RobotMain
+#include "../hotshot/auto.c"
+#undef main
+
+//
+// Motor model constants.
+//
+#ifndef SIM_MOTOR_RPM
+  #define SIM_MOTOR_RPM         152.0   //free speed at full power
+#endif
+#ifndef SIM_MOTOR_TAU
+  #define SIM_MOTOR_TAU         100.0   //time constant in msec
+#endif
+#ifndef SIM_MOTOR_DEADBAND
+  #define SIM_MOTOR_DEADBAND    3       //power that does not turn the motor
+#endif
+#define SIM_DEFAULT_TIMEOUT     30      //in sec
+#define SIM_BUMP_TIME           100     //in msec
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  int    idMotor;
+  double rpm;
+  double clicks;
+  double velGround;             //in inches/msec
+  double slip;                  //in inches
+} SIM_MOTOR;
+
+typedef struct
+{
+  SIM_MOTOR motorLeft;
+  SIM_MOTOR motorRight;
+  double    x;
+  double    y;
+  double    heading;            //in radians
+  double    rateGyro;           //in degrees/sec, + is right
+  long      timeBump;           //-1 if no bump
+  double    bumpRate;           //in radians/msec
+  long      timeout;
+  long      timeStall;
+  long      timeDone;
+  double    traction;           //in inches/msec^2, 0 if no limit
+  double    overshoot;          //in inches
+  bool      fStarted;
+} SIM;
+
+class SimDone {};
+
+//
+// Global data.
+//
+SIM g_Sim;
+
+/// <summary>
+///   This function advances a motor by one msec. The motor speed follows
+///   the power with a first order lag. The ground speed of the wheel
+///   follows the motor as fast as the traction allows.
+/// </summary>
+///
+/// <param name="simMotor">
+///   Points to the SIM_MOTOR structure.
+/// </param>
+///
+/// <returns> Returns the distance travelled by the wheel on the ground in
+///           inches. </returns>
+
+double
+SimMotorStep(
+  SIM_MOTOR &simMotor
+  )
+{
+  int power = BOUND(motor[simMotor.idMotor], -100, 100);
+  double rpmTarget = (abs(power) <= SIM_MOTOR_DEADBAND)?
+                     0.0: SIM_MOTOR_RPM*power/100.0;
+  double clicksPrev = simMotor.clicks;
+  double velWheel;
+  bool fStalled = (g_Sim.timeStall >= 0) && (g_SimTime >= g_Sim.timeStall);
+
+  simMotor.rpm += (rpmTarget - simMotor.rpm)/SIM_MOTOR_TAU;
+  if (fStalled)
+  {
+    simMotor.rpm = 0.0;
+  }
+  simMotor.clicks += simMotor.rpm*CLICKS_PER_REVOLUTION/60000.0;
+  //
+  // Encoder resets by the program move the counter, not the wheel.
+  //
+  nMotorEncoder[simMotor.idMotor] += (long)simMotor.clicks - (long)clicksPrev;
+
+  velWheel = (simMotor.clicks - clicksPrev)/CLICKS_PER_DISTANCE;
+  if ((g_Sim.traction <= 0.0) || fStalled)
+  {
+    simMotor.velGround = velWheel;
+  }
+  else
+  {
+    simMotor.velGround += BOUND(velWheel - simMotor.velGround,
+                                -g_Sim.traction, g_Sim.traction);
+  }
+  simMotor.slip += fabs(velWheel - simMotor.velGround);
+
+  return simMotor.velGround;
+}   //SimMotorStep
+
+/// <summary>
+///   This function keeps the largest distance a wheel has gone past the
+///   target of a profiled PID drive move.
+/// </summary>
+///
+/// <param name="clickTarget">
+///   Specifies the target of the wheel.
+/// </param>
+/// <param name="clickStart">
+///   Specifies the start of the wheel.
+/// </param>
+/// <param name="simMotor">
+///   Points to the SIM_MOTOR structure of the wheel.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SimOvershoot(
+  int clickTarget,
+  int clickStart,
+  SIM_MOTOR &simMotor
+  )
+{
+  double over = (nMotorEncoder[simMotor.idMotor] - clickTarget)/
+                CLICKS_PER_DISTANCE;
+
+  if (clickTarget < clickStart)
+  {
+    over = -over;
+  }
+  if (over > g_Sim.overshoot)
+  {
+    g_Sim.overshoot = over;
+  }
+
+  return;
+}   //SimOvershoot
+
+/// <summary>
+///   This function is called by wait1Msec. It advances the clock and the
+///   drive model one msec at a time and ends the run when the autonomous
+///   state machine is done or the timeout expires.
+/// </summary>
+///
+/// <param name="msec">
+///   Specifies the time to advance in msec.
+/// </param>
+///
+/// <returns> None. </returns>
+
+void
+SimStep(
+  int msec
+  )
+{
+  for (int i = 0; i < msec; ++i)
+  {
+    double distLeft = SimMotorStep(g_Sim.motorLeft);
+    double distRight = SimMotorStep(g_Sim.motorRight);
+    double dist = (distLeft + distRight)/2.0;
+    double turn = (distRight - distLeft)/WHEELBASE_DISTANCE;
+
+    if ((g_Sim.timeBump >= 0) && (g_SimTime >= g_Sim.timeBump) &&
+        (g_SimTime < g_Sim.timeBump + SIM_BUMP_TIME))
+    {
+      turn -= g_Sim.bumpRate;
+    }
+    g_Sim.heading += turn;
+    g_Sim.rateGyro = -turn*180.0/PI*1000.0;
+    g_Sim.x += dist*cos(g_Sim.heading);
+    g_Sim.y += dist*sin(g_Sim.heading);
+    g_SimTime++;
+  }
+
+  if (((g_Drive.modeDrive == DRIVEMODE_PID_DISTANCE) ||
+       (g_Drive.modeDrive == DRIVEMODE_PID_ANGLE)) && g_Drive.fProfile)
+  {
+    SimOvershoot(g_Drive.clickTargetLeft, g_Drive.clickStartLeft,
+                 g_Sim.motorLeft);
+    SimOvershoot(g_Drive.clickTargetRight, g_Drive.clickStartRight,
+                 g_Sim.motorRight);
+  }
+
+  if (IsSMEnabled(g_AutoSM))
+  {
+    g_Sim.fStarted = true;
+  }
+  else if (g_Sim.fStarted)
+  {
+    g_Sim.timeDone = g_SimTime;
+    throw SimDone();
+  }
+
+  if (g_SimTime >= g_Sim.timeout)
+  {
+    throw SimDone();
+  }
+
+  return;
+}   //SimStep
+
+/// <summary>
+///   This function is called by HTGYROreadRot to read the gyro.
+/// </summary>
+///
+/// <returns> Returns the turn rate of the last msec in degrees/sec, + is
+///           right. </returns>
+
+double
+SimGyroRate()
+{
+  return g_Sim.rateGyro;
+}   //SimGyroRate
+
+int
+main(
+  int argc,
+  char *argv[]
+  )
+{
+  int timeout = SIM_DEFAULT_TIMEOUT;
+  double timeStall = -1.0;
+  double traction = 0.0;
+  double timeBump = -1.0;
+  double angleBump = 0.0;
+  clock_t clockStart;
+  double timeWall;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if ((strcmp(argv[i], "-p") == 0) && (i + 1 < argc))
+    {
+      g_StartPos = atoi(argv[++i]);
+    }
+    else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+    {
+      timeout = atoi(argv[++i]);
+    }
+    else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+    {
+      timeStall = atof(argv[++i]);
+    }
+    else if ((strcmp(argv[i], "-g") == 0) && (i + 1 < argc))
+    {
+      traction = atof(argv[++i]);
+    }
+    else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc) &&
+             (sscanf(argv[i + 1], "%lf,%lf", &timeBump, &angleBump) == 2))
+    {
+      i++;
+    }
+    else if (strcmp(argv[i], "-n") == 0)
+    {
+      g_SimChain = false;
+    }
+    else if (strcmp(argv[i], "-u") == 0)
+    {
+      g_SimProfile = false;
+    }
+    else if (strcmp(argv[i], "-f") == 0)
+    {
+      g_SimFeedForward = false;
+    }
+    else if (strcmp(argv[i], "-c") == 0)
+    {
+      g_SimTolerance = false;
+    }
+    else if (strcmp(argv[i], "-y") == 0)
+    {
+      g_SimHeadingHold = false;
+    }
+    else if (strcmp(argv[i], "-q") == 0)
+    {
+      g_SimDebugStream = fopen("/dev/null", "w");
+    }
+    else if ((strcmp(argv[i], "-a") == 0) && (i + 1 < argc))
+    {
+      g_SimAutoFile = argv[++i];
+    }
+    else if (((strcmp(argv[i], "-r") == 0) || (strcmp(argv[i], "-R") == 0)) &&
+             (i + 1 < argc))
+    {
+      g_SimRplMode = (argv[i][1] == 'r')? RPLMODE_RECORD: RPLMODE_REPLAY;
+      g_SimRplFile = argv[++i];
+    }
+    else
+    {
+      fprintf(stderr,
+              "Usage: %s [-p startPos] [-t timeout] [-s stallTime] "
+              "[-g traction] [-b time,angle] [-n] [-u] [-f] [-c] [-y] [-q] "
+              "[-a stepFile] [-r|-R logFile]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  memset(&g_Sim, 0, sizeof(g_Sim));
+  g_Sim.motorLeft.idMotor = motorG;
+  g_Sim.motorRight.idMotor = motorF;
+  g_Sim.timeout = timeout*1000L;
+  g_Sim.timeStall = (timeStall >= 0.0)? (long)(timeStall*1000.0): -1;
+  g_Sim.timeDone = -1;
+  g_Sim.traction = (traction > 0.0)? traction/1000000.0: 0.0;
+  g_Sim.timeBump = (timeBump >= 0.0)? (long)(timeBump*1000.0): -1;
+  g_Sim.bumpRate = angleBump*PI/180.0/SIM_BUMP_TIME;
+
+  clockStart = clock();
+  try
+  {
+    RobotMain();
+  }
+  catch (SimDone &)
+  {
+  }
+  timeWall = (double)(clock() - clockStart)/CLOCKS_PER_SEC;
+
+  if (g_Sim.timeDone >= 0)
+  {
+    printf("StartPos %d: done in %.3f s\n", g_StartPos, g_Sim.timeDone/1000.0);
+  }
+  else
+  {
+    printf("StartPos %d: timed out after %.3f s (state %d)\n",
+           g_StartPos, g_SimTime/1000.0, g_AutoSM.currState);
+  }
+  printf("Pose: x=%.2f in, y=%.2f in, heading=%.1f deg\n",
+         g_Sim.x, g_Sim.y, g_Sim.heading*180.0/PI);
+  if ((g_StartPos >= 0) && (g_StartPos < g_AutoLib.nRoutines))
+  {
+    printf("Routine: %s, %d of %d loaded in %ld msec\n",
+           g_AutoLib.Routines[g_StartPos].name.c_str(), g_StartPos + 1,
+           g_AutoLib.nRoutines, g_AutoLib.timeLoad);
+  }
+  if (g_SimProfile)
+  {
+    printf("Overshoot: %.2f in\n", g_Sim.overshoot);
+  }
+  if (g_Sim.traction > 0.0)
+  {
+    printf("Slip: left %.2f in, right %.2f in\n",
+           g_Sim.motorLeft.slip, g_Sim.motorRight.slip);
+  }
+  printf("Loop: %ld overruns, max late %ld msec\n",
+         g_Sched.cntOverruns, g_Sched.timeMaxLate);
+  printf("Events: %ld posted, %ld overflows, max depth %d\n",
+         g_EvtQueue.cntPosts, g_EvtQueue.cntOverflows, g_EvtQueue.maxDepth);
+  if ((g_AutoSM.cntTransitions > 0) && (g_EvtQueue.cntDrained > 0))
+  {
+    printf("Latency: queue %.2f/%ld msec, event to action %.2f/%ld msec "
+           "avg/max, %ld msec dead time, %ld transitions\n",
+           (double)g_EvtQueue.timeLatTotal/g_EvtQueue.cntDrained,
+           g_EvtQueue.timeLatMax,
+           (double)g_AutoSM.timeLatTotal/g_AutoSM.cntTransitions,
+           g_AutoSM.timeLatMax,
+           g_EvtQueue.timeLatTotal + g_AutoSM.timeLatTotal,
+           g_AutoSM.cntTransitions);
+  }
+  if (g_Rpl.cntFrames > 0)
+  {
+    printf("Replay: %ld frames, %ld bytes\n", g_Rpl.cntFrames, g_Rpl.cntBytes);
+  }
+  printf("Wall time: %.3f s (%.0fx real time)\n",
+         timeWall, (timeWall > 0.0)? g_SimTime/1000.0/timeWall: 0.0);
+
+  return (g_Sim.timeDone >= 0)? 0: 1;
+}   //main
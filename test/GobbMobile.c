@@ -27,13 +27,15 @@
 /// </remarks>
 #endif
 
-#include "..\lib\common.h"
-#include "..\lib\trace.h"
-#include "..\lib\button.h"
-#include "..\lib\display.h"
-#include "..\lib\sensor.h"
-#include "..\lib\drive.h"
-#include "..\lib\sm.h"
+#include "../lib/common.h"
+#include "../lib/trace.h"
+#include "../lib/profile.h"
+#include "../lib/button.h"
+#include "../lib/replay.h"
+#include "../lib/display.h"
+#include "../lib/sensor.h"
+#include "../lib/drive.h"
+#include "../lib/sm.h"
 #include "grabber.h"
 
 #ifdef MOD_ID
@@ -41,6 +43,43 @@
 #endif
 #define MOD_ID                  MOD_MAIN
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_BUTTONEVENT         (FIDBASE_MAIN + 0)
+#define FID_SENSOREVENT         (FIDBASE_MAIN + 1)
+#define FID_DRIVEEVENT          (FIDBASE_MAIN + 2)
+#define FID_AUTONOMOUSSM        (FIDBASE_MAIN + 3)
+#define FID_LINEFOLLOWERINIT    (FIDBASE_MAIN + 4)
+#define FID_ROBOTINIT           (FIDBASE_MAIN + 5)
+#define FID_INPUTTASKS          (FIDBASE_MAIN + 6)
+#define FID_MAINTASKS           (FIDBASE_MAIN + 7)
+#define FID_OUTPUTTASKS         (FIDBASE_MAIN + 8)
+
+#ifdef _TRACE_FUNCNAMES
+string g_GobbMobileFuncNames[9] =
+{
+  "ButtonEvent",
+  "SensorEvent",
+  "DriveEvent",
+  "AutonomousSM",
+  "LineFollowerInit",
+  "RobotInit",
+  "InputTasks",
+  "MainTasks",
+  "OutputTasks"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_GobbMobileFuncNames
+
+//
+// End of generated function IDs.
+//
+
 #define EVTTYPE_BUTTON          (EVTTYPE_NONE + 1)
 #define EVTTYPE_SENSOR          (EVTTYPE_NONE + 2)
 #define EVTTYPE_DRIVE           (EVTTYPE_NONE + 3)
@@ -225,7 +264,7 @@ ButtonEvent(
   __in BUTTON &button
   )
 {
-  TFuncName("ButtonEvent");
+  TFuncId(FID_BUTTONEVENT);
   TEnterMsg(EVENT, ("Button=%x,On=%d", button.maskButton, (byte)button.fPressed));
 
   if (button.idJoystick == 1)
@@ -277,7 +316,7 @@ SensorEvent(
   __in SENSOR &sensor
   )
 {
-  TFuncName("SensorEvent");
+  TFuncId(FID_SENSOREVENT);
   TEnterMsg(EVENT, ("Sensor=%d,Zone=%d", sensor.idSensor, sensor.zoneSensor));
 
   switch (sensor.idSensor)
@@ -313,7 +352,7 @@ DriveEvent(
   __in DRIVE &drive
   )
 {
-  TFuncName("DriveEvent");
+  TFuncId(FID_DRIVEEVENT);
   TEnterMsg(EVENT, ("Mode=%d", drive.modeDrive));
 
   if (IsSMEnabled(g_AutoSM))
@@ -450,7 +489,7 @@ AutonomousSM(
   __inout SM &sm
   )
 {
-  TFuncName("AutonomousSM");
+  TFuncId(FID_AUTONOMOUSSM);
   TEnter(HIFREQ);
 
   if (IsSMReady(sm))
@@ -517,7 +556,7 @@ AutonomousSM(
 void
 LineFollowerInit()
 {
-  TFuncName("LineFollowerInit");
+  TFuncId(FID_LINEFOLLOWERINIT);
   TEnter(INIT);
 
   InitLFUnused(g_LineFollower[0]);
@@ -561,7 +600,7 @@ LineFollowerInit()
 void
 RobotInit()
 {
-  TFuncName("RobotInit");
+  TFuncId(FID_ROBOTINIT);
   TEnter(INIT);
 
   LineFollowerInit();
@@ -615,7 +654,7 @@ RobotInit()
 void
 InputTasks()
 {
-  TFuncName("InputTasks");
+  TFuncId(FID_INPUTTASKS);
   TEnter(HIFREQ);
 
   getJoystickSettings(joystick);
@@ -638,7 +677,7 @@ InputTasks()
 void
 MainTasks()
 {
-  TFuncName("MainTasks");
+  TFuncId(FID_MAINTASKS);
   TEnter(HIFREQ);
 
   int powerDrive = NORMALIZE(DEADBAND_INPUT(joystick.joy1_y1),
@@ -694,7 +733,7 @@ MainTasks()
 void
 OutputTasks()
 {
-  TFuncName("OutputTasks");
+  TFuncId(FID_OUTPUTTASKS);
   TEnter(HIFREQ);
 
   DriveTask(g_Drive);
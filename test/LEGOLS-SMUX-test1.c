@@ -21,7 +21,7 @@
  * version 0.2
  */
 
-#include "..\drivers\LEGOLS-driver.h"
+#include "../drivers/LEGOLS-driver.h"
 
 task main() {
   int raw1 = 0;
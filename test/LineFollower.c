@@ -24,20 +24,59 @@
 #define MAX_LIGHT_SENSORS       3
 #define MAX_LN_FOLLOWACTIONS    27
 
-#include "..\lib\common.h"
-#include "..\lib\trace.h"
-#include "..\lib\button.h"
-#include "..\lib\display.h"
-#include "..\lib\sensor.h"
-#include "..\lib\drive.h"
-#include "..\lib\sm.h"
-#include "..\lib\lnfollow.h"
+#include "../lib/common.h"
+#include "../lib/trace.h"
+#include "../lib/profile.h"
+#include "../lib/button.h"
+#include "../lib/replay.h"
+#include "../lib/display.h"
+#include "../lib/sensor.h"
+#include "../lib/drive.h"
+#include "../lib/sm.h"
+#include "../lib/lnfollow.h"
 
 #ifdef MOD_ID
   #undef MOD_ID
 #endif
 #define MOD_ID                  MOD_MAIN
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_BUTTONEVENT         (FIDBASE_MAIN + 0)
+#define FID_SENSOREVENT         (FIDBASE_MAIN + 1)
+#define FID_DRIVEEVENT          (FIDBASE_MAIN + 2)
+#define FID_AUTONOMOUSSM        (FIDBASE_MAIN + 3)
+#define FID_INITLNFOLLOWACTIONS (FIDBASE_MAIN + 4)
+#define FID_ROBOTINIT           (FIDBASE_MAIN + 5)
+#define FID_INPUTTASKS          (FIDBASE_MAIN + 6)
+#define FID_MAINTASKS           (FIDBASE_MAIN + 7)
+#define FID_OUTPUTTASKS         (FIDBASE_MAIN + 8)
+
+#ifdef _TRACE_FUNCNAMES
+string g_LineFollowerFuncNames[9] =
+{
+  "ButtonEvent",
+  "SensorEvent",
+  "DriveEvent",
+  "AutonomousSM",
+  "InitLnFollowActions",
+  "RobotInit",
+  "InputTasks",
+  "MainTasks",
+  "OutputTasks"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_LineFollowerFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Trace info.
 //
@@ -156,7 +195,7 @@ ButtonEvent(
   __in BUTTON &button
   )
 {
-  TFuncName("ButtonEvent");
+  TFuncId(FID_BUTTONEVENT);
   TEnterMsg(EVENT, ("Button=%x,On=%d", button.maskButton, (byte)button.fPressed));
 
   if (button.idJoystick == 1)
@@ -259,7 +298,7 @@ SensorEvent(
   __in SENSOR &sensor
   )
 {
-  TFuncName("SensorEvent");
+  TFuncId(FID_SENSOREVENT);
   TEnterMsg(EVENT, ("Sensor=%d,Zone=%d", sensor.idSensor, sensor.zoneSensor));
 
   switch (sensor.idSensor)
@@ -290,7 +329,7 @@ DriveEvent(
   __in DRIVE &drive
   )
 {
-  TFuncName("DriveEvent");
+  TFuncId(FID_DRIVEEVENT);
   TEnterMsg(EVENT, ("Mode=%d", drive.modeDrive));
 
   if (IsSMEnabled(g_AutoSM))
@@ -333,7 +372,7 @@ AutonomousSM(
   __inout SM &sm
   )
 {
-  TFuncName("AutonomousSM");
+  TFuncId(FID_AUTONOMOUSSM);
   TEnter(HIFREQ);
 
   if (IsSMReady(sm))
@@ -385,7 +424,7 @@ AutonomousSM(
 void
 InitLnFollowActions()
 {
-  TFuncName("InitLnFollowActions");
+  TFuncId(FID_INITLNFOLLOWACTIONS);
   TEnter(INIT);
 
 #if 0
@@ -458,7 +497,7 @@ InitLnFollowActions()
 void
 RobotInit()
 {
-  TFuncName("RobotInit");
+  TFuncId(FID_ROBOTINIT);
   TEnter(INIT);
 
   InitLnFollowActions();
@@ -511,7 +550,7 @@ RobotInit()
 void
 InputTasks()
 {
-  TFuncName("InputTasks");
+  TFuncId(FID_INPUTTASKS);
   TEnter(HIFREQ);
 
   getJoystickSettings(joystick);
@@ -531,7 +570,7 @@ InputTasks()
 void
 MainTasks()
 {
-  TFuncName("MainTasks");
+  TFuncId(FID_MAINTASKS);
   TEnter(HIFREQ);
 
   int powerDrive = NORMALIZE(DEADBAND_INPUT(joystick.joy1_y1),
@@ -597,7 +636,7 @@ MainTasks()
 void
 OutputTasks()
 {
-  TFuncName("OutputTasks");
+  TFuncId(FID_OUTPUTTASKS);
   TEnter(HIFREQ);
 
   DriveTask(g_Drive);
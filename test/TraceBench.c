@@ -0,0 +1,160 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="tracebench.c" />
+///
+/// <summary>
+///   This module contains the benchmark of the per-call trace overhead in
+///   _DEBUG builds when the trace level filters everything out.
+/// </summary>
+///
+/// <remarks>
+///   Environment: RobotC for Lego Mindstorms NXT.
+///   It compares a function that declares its name the old way with a
+///   string local against the same function using TFuncId. The results are
+///   in usec per call and are shown on the LCD and the debug stream.
+/// </remarks>
+#endif
+
+#ifndef _DEBUG
+  #define _DEBUG
+#endif
+
+#include "../lib/common.h"
+#include "../lib/trace.h"
+
+#ifdef MOD_ID
+  #undef MOD_ID
+#endif
+#define MOD_ID                  MOD_MAIN
+
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_BENCHFUNCID         (FIDBASE_MAIN + 0)
+
+#ifdef _TRACE_FUNCNAMES
+string g_TraceBenchFuncNames[1] =
+{
+  "BenchFuncId"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_TraceBenchFuncNames
+
+//
+// End of generated function IDs.
+//
+
+#define NUM_CALLS               2000
+
+int g_Count = 0;
+
+/// <summary>
+///   This function has the trace hooks of a HIFREQ function with the name
+///   declared as a string local, which is what TFuncName used to do.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+BenchFuncString()
+{
+  string _strFuncName = "BenchFuncString";
+  if (((g_TraceModules & MOD_ID) != 0) && (HIFREQ <= g_TraceLevel))
+  {
+    writeDebugStream(_strFuncName);
+  }
+
+  g_Count++;
+
+  if (((g_TraceModules & MOD_ID) != 0) && (HIFREQ <= g_TraceLevel))
+  {
+    writeDebugStream(_strFuncName);
+  }
+  return;
+}   //BenchFuncString
+
+/// <summary>
+///   This function has the trace hooks of a HIFREQ function with the name
+///   declared as a function ID.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+BenchFuncId()
+{
+  TFuncId(FID_BENCHFUNCID);
+  TEnter(HIFREQ);
+
+  g_Count++;
+
+  TExit(HIFREQ);
+  return;
+}   //BenchFuncId
+
+/// <summary>
+///   This function has no trace hooks and gives the baseline call cost.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+void
+BenchFuncNone()
+{
+  g_Count++;
+  return;
+}   //BenchFuncNone
+
+task main()
+{
+  long timeNone;
+  long timeString;
+  long timeId;
+
+  //
+  // Trace everything except HIFREQ so the hooks are evaluated but filtered.
+  //
+  TraceInit(MOD_MAIN, UTIL, INFO);
+  eraseDisplay();
+
+  time1[T1] = 0;
+  for (int i = 0; i < NUM_CALLS; ++i)
+  {
+    BenchFuncNone();
+  }
+  timeNone = time1[T1];
+
+  time1[T1] = 0;
+  for (int i = 0; i < NUM_CALLS; ++i)
+  {
+    BenchFuncString();
+  }
+  timeString = time1[T1];
+
+  time1[T1] = 0;
+  for (int i = 0; i < NUM_CALLS; ++i)
+  {
+    BenchFuncId();
+  }
+  timeId = time1[T1];
+
+  //
+  // Per call cost in usec over the baseline.
+  //
+  nxtDisplayTextLine(0, "usec/call");
+  nxtDisplayTextLine(1, "None:   %d", timeNone*1000/NUM_CALLS);
+  nxtDisplayTextLine(2, "String: %d", (timeString - timeNone)*1000/NUM_CALLS);
+  nxtDisplayTextLine(3, "FuncId: %d", (timeId - timeNone)*1000/NUM_CALLS);
+  debugPrintLine("None=%d,String=%d,FuncId=%d msec/%d calls",
+                 timeNone, timeString, timeId, NUM_CALLS);
+
+  while (true)
+  {
+    wait1Msec(1000);
+  }
+}   //main
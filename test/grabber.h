@@ -18,8 +18,38 @@
   #undef MOD_ID
 #endif
 #define MOD_GRABBER                     TGenModId(1)
+#define FIDBASE_GRABBER                 TGenFidBase(1)
 #define MOD_ID                          MOD_GRABBER
 
+//
+// Function IDs (generated by tools/genfid.c, do not edit).
+//
+#define FID_GRABBERRESET        (FIDBASE_GRABBER + 0)
+#define FID_GRABBERSTARTCAL     (FIDBASE_GRABBER + 1)
+#define FID_GRABBERINIT         (FIDBASE_GRABBER + 2)
+#define FID_GRABBERSETPOWER     (FIDBASE_GRABBER + 3)
+#define FID_GRABBERTASK         (FIDBASE_GRABBER + 4)
+
+#ifdef _TRACE_FUNCNAMES
+string g_GrabberFuncNames[5] =
+{
+  "GrabberReset",
+  "GrabberStartCal",
+  "GrabberInit",
+  "GrabberSetPower",
+  "GrabberTask"
+};
+#endif
+
+#ifdef MOD_FUNCNAMES
+  #undef MOD_FUNCNAMES
+#endif
+#define MOD_FUNCNAMES           g_GrabberFuncNames
+
+//
+// End of generated function IDs.
+//
+
 //
 // Constants.
 //
@@ -62,7 +92,7 @@ GrabberReset(
   __out GRABBER &grabber
   )
 {
-  TFuncName("GrabberReset");
+  TFuncId(FID_GRABBERRESET);
   TEnter(FUNC);
 
   grabber.modeGrabber = GRABBERMODE_STOPPED;
@@ -92,7 +122,7 @@ GrabberStartCal(
   __inout GRABBER &grabber
   )
 {
-  TFuncName("GrabberStartCal");
+  TFuncId(FID_GRABBERSTARTCAL);
   TEnter(API);
 
   if (!grabber.fCalibrating)
@@ -146,7 +176,7 @@ GrabberInit(
   __in long timeStep
   )
 {
-  TFuncName("GrabberInit");
+  TFuncId(FID_GRABBERINIT);
   TEnter(INIT);
 
   grabber.motorGrabber = motorGrabber;
@@ -183,7 +213,7 @@ GrabberSetPower(
   __in int powerGrabber
   )
 {
-  TFuncName("GrabberSetPower");
+  TFuncId(FID_GRABBERSETPOWER);
   TEnterMsg(API, ("Power=%d", powerGrabber));
 
   if (!grabber.fCalibrating)
@@ -219,7 +249,7 @@ GrabberTask(
   __inout GRABBER &grabber
   )
 {
-  TFuncName("GrabberTask");
+  TFuncId(FID_GRABBERTASK);
   TEnter(HIFREQ);
 
   static bool fMoving = false;
@@ -0,0 +1,376 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="genfid.c" />
+///
+/// <summary>
+///   This module contains the host side generator for the function ID
+///   registry of the trace module (lib/trace.h).
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, standard C.
+///   Build: cc -o genfid tools/genfid.c
+///   Usage: genfid <source files...>
+///   Each traced function declares its ID with TFuncId(FID_XXX) where XXX
+///   is the function name in upper case. For each source file, genfid
+///   collects these IDs in source order and rewrites the generated block
+///   after the MOD_ID definition. The block defines the FID_ constants
+///   relative to the FIDBASE_ of the module and the name table used by the
+///   text trace backend. Run it again whenever a traced function is added,
+///   removed or renamed.
+/// </remarks>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+//
+// Constants.
+//
+#define MAX_LINES               4096
+#define MAX_LINE_LEN            512
+#define MAX_NAME_LEN            64
+#define MAX_MOD_FUNCS           32
+
+#define BLOCK_BEGIN             "// Function IDs (generated by tools/genfid.c, do not edit)."
+#define BLOCK_END               "// End of generated function IDs."
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  char funcName[MAX_NAME_LEN];
+  char fidName[MAX_NAME_LEN];
+} FUNC;
+
+//
+// Global data.
+//
+static char *g_Lines[MAX_LINES];
+static int   g_NumLines = 0;
+static FUNC  g_Funcs[MAX_MOD_FUNCS];
+static int   g_NumFuncs = 0;
+
+/// <summary>
+///   This function reads a source file into g_Lines.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the source file path.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+ReadFile(
+  const char *path
+  )
+{
+  FILE *file = fopen(path, "r");
+  char buff[MAX_LINE_LEN];
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "genfid: cannot open %s\n", path);
+    return -1;
+  }
+
+  g_NumLines = 0;
+  while ((g_NumLines < MAX_LINES) && (fgets(buff, sizeof(buff), file) != NULL))
+  {
+    g_Lines[g_NumLines] = malloc(strlen(buff) + 1);
+    strcpy(g_Lines[g_NumLines], buff);
+    g_NumLines++;
+  }
+  fclose(file);
+
+  return 0;
+}   //ReadFile
+
+/// <summary>
+///   This function determines if a line is a function header and returns
+///   the function name if it is.
+/// </summary>
+///
+/// <param name="line">
+///   Specifies the source line.
+/// </param>
+/// <param name="name">
+///   Receives the function name.
+/// </param>
+///
+/// <returns> Returns 1 if the line is a function header, 0 otherwise. </returns>
+
+static int
+IsFuncHeader(
+  const char *line,
+  char *name
+  )
+{
+  int n = 0;
+
+  if (strncmp(line, "task ", 5) == 0)
+  {
+    line += 5;
+  }
+
+  return (!isdigit((unsigned char)line[0]) &&
+          (sscanf(line, "%63[A-Za-z0-9_]%n", name, &n) == 1) &&
+          (line[n] == '('));
+}   //IsFuncHeader
+
+/// <summary>
+///   This function collects the TFuncId declarations of the file and checks
+///   that each one is named after its function.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the source file path for error messages.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+CollectFuncs(
+  const char *path
+  )
+{
+  char funcName[MAX_NAME_LEN] = "?";
+  char name[MAX_NAME_LEN];
+  int rc = 0;
+  int i;
+
+  g_NumFuncs = 0;
+  for (i = 0; i < g_NumLines; ++i)
+  {
+    char *p;
+
+    if (IsFuncHeader(g_Lines[i], name))
+    {
+      strcpy(funcName, name);
+    }
+    else if (((p = strstr(g_Lines[i], "TFuncId(")) != NULL) &&
+             (strstr(g_Lines[i], "#define") == NULL) &&
+             (sscanf(p + strlen("TFuncId("), "%63[A-Za-z0-9_]", name) == 1))
+    {
+      char expected[MAX_NAME_LEN + 4];
+      char *q;
+
+      sprintf(expected, "FID_%s", funcName);
+      for (q = expected; *q != '\0'; ++q)
+      {
+        *q = toupper((unsigned char)*q);
+      }
+
+      if (strcmp(name, expected) != 0)
+      {
+        fprintf(stderr, "%s:%d: %s should be %s\n",
+                path, i + 1, name, expected);
+        rc = -1;
+      }
+      else if (g_NumFuncs >= MAX_MOD_FUNCS)
+      {
+        fprintf(stderr, "%s:%d: more than %d traced functions\n",
+                path, i + 1, MAX_MOD_FUNCS);
+        rc = -1;
+      }
+      else
+      {
+        strcpy(g_Funcs[g_NumFuncs].funcName, funcName);
+        strcpy(g_Funcs[g_NumFuncs].fidName, name);
+        g_NumFuncs++;
+      }
+    }
+  }
+
+  return rc;
+}   //CollectFuncs
+
+/// <summary>
+///   This function writes the generated block.
+/// </summary>
+///
+/// <param name="file">
+///   Specifies the output file.
+/// </param>
+/// <param name="modName">
+///   Specifies the module name without the MOD_ prefix.
+/// </param>
+/// <param name="tableName">
+///   Specifies the name of the name table.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+WriteBlock(
+  FILE *file,
+  const char *modName,
+  const char *tableName
+  )
+{
+  int i;
+
+  fprintf(file, "//\n%s\n//\n", BLOCK_BEGIN);
+  for (i = 0; i < g_NumFuncs; ++i)
+  {
+    fprintf(file, "#define %-23s (FIDBASE_%s + %d)\n",
+            g_Funcs[i].fidName, modName, i);
+  }
+  fprintf(file, "\n#ifdef _TRACE_FUNCNAMES\n");
+  fprintf(file, "string %s[%d] =\n{\n", tableName, g_NumFuncs);
+  for (i = 0; i < g_NumFuncs; ++i)
+  {
+    fprintf(file, "  \"%s\"%s\n",
+            g_Funcs[i].funcName, (i < g_NumFuncs - 1)? ",": "");
+  }
+  fprintf(file, "};\n#endif\n\n");
+  fprintf(file, "#ifdef MOD_FUNCNAMES\n  #undef MOD_FUNCNAMES\n#endif\n");
+  fprintf(file, "#define %-23s %s\n", "MOD_FUNCNAMES", tableName);
+  fprintf(file, "\n//\n%s\n//\n", BLOCK_END);
+
+  return;
+}   //WriteBlock
+
+/// <summary>
+///   This function generates the function ID block of a source file and
+///   rewrites the file. The block replaces the previous one if there is
+///   one, otherwise it is inserted after the MOD_ID definition.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the source file path.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+GenFile(
+  const char *path
+  )
+{
+  char modName[MAX_NAME_LEN] = "";
+  char tableName[MAX_NAME_LEN + 16];
+  const char *base;
+  int iModId = -1;
+  int iBegin = -1;
+  int iEnd = -1;
+  FILE *file;
+  int i;
+
+  if ((ReadFile(path) != 0) || (CollectFuncs(path) != 0))
+  {
+    return -1;
+  }
+
+  for (i = 0; i < g_NumLines; ++i)
+  {
+    if (sscanf(g_Lines[i], "#define MOD_ID MOD_%63[A-Za-z0-9_]", modName) == 1)
+    {
+      iModId = i;
+    }
+    else if (strncmp(g_Lines[i], BLOCK_BEGIN, strlen(BLOCK_BEGIN)) == 0)
+    {
+      //
+      // The block starts with the "//" line above the title.
+      //
+      iBegin = i - 1;
+    }
+    else if (strncmp(g_Lines[i], BLOCK_END, strlen(BLOCK_END)) == 0)
+    {
+      //
+      // The block ends with the "//" line below the title.
+      //
+      iEnd = i + 1;
+    }
+  }
+
+  if (iModId < 0)
+  {
+    fprintf(stderr, "%s: no MOD_ID definition\n", path);
+    return -1;
+  }
+
+  //
+  // The name table is named after the file, e.g. drive.h gives
+  // g_DriveFuncNames.
+  //
+  base = strrchr(path, '/');
+  base = (base != NULL)? base + 1: path;
+  sprintf(tableName, "g_%c", toupper((unsigned char)base[0]));
+  for (i = 1; (base[i] != '\0') && (base[i] != '.'); ++i)
+  {
+    tableName[i + 2] = base[i];
+  }
+  tableName[i + 2] = '\0';
+  strcat(tableName, "FuncNames");
+
+  if ((file = fopen(path, "w")) == NULL)
+  {
+    fprintf(stderr, "genfid: cannot write %s\n", path);
+    return -1;
+  }
+
+  for (i = 0; i < g_NumLines; ++i)
+  {
+    if ((iBegin >= 0) && (iEnd > iBegin))
+    {
+      if (i == iBegin)
+      {
+        WriteBlock(file, modName, tableName);
+      }
+      if ((i >= iBegin) && (i <= iEnd))
+      {
+        continue;
+      }
+    }
+    fputs(g_Lines[i], file);
+    if ((iBegin < 0) && (i == iModId))
+    {
+      fputs("\n", file);
+      WriteBlock(file, modName, tableName);
+    }
+  }
+  fclose(file);
+
+  for (i = 0; i < g_NumLines; ++i)
+  {
+    free(g_Lines[i]);
+  }
+  printf("%s: %d functions\n", path, g_NumFuncs);
+
+  return 0;
+}   //GenFile
+
+int
+main(
+  int argc,
+  char *argv[]
+  )
+{
+  int rc = 0;
+  int i;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage: genfid <source files...>\n");
+    return 2;
+  }
+
+  for (i = 1; i < argc; ++i)
+  {
+    if (GenFile(argv[i]) != 0)
+    {
+      rc = 1;
+    }
+  }
+
+  return rc;
+}   //main
@@ -0,0 +1,1934 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="scrc.c" />
+///
+/// <summary>
+///   This module contains the host side compiler of the autonomous scripts
+///   from a text file to the packed step tables of the script module
+///   (lib/script.h).
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, standard C.
+///   Build: cc -o scrc tools/scrc.c -lm
+///   Usage: scrc [-m motorRPM] [-d defsFile]... [-b stepFile] script.scr
+///               [header.h]
+///   A script file has one or more scripts, each one between a
+///   "script <name> [mirror]" line and an "end" line. mirror sets
+///   SCRF_MIRROR on the script. Every other line has one step
+///   or several steps separated by ';', and '#' starts a comment. A step
+///   is one action, or several actions separated by '&' to wait for all of
+///   them or by '|' to wait for the first one:
+///     drive <inches> [@power]     turn <degrees> [@power]
+///     shoot <msec> [@power]       spinup [@power]
+///     pickup <msec> [@power]      wait <msec>
+///   The power of drive and turn is the motor power limit, and with
+///   DRIVE_PROFILE also the percentage of DRIVE_VEL_MAX to cruise at, as
+///   DriveProfileStart takes it.
+///   An action can be followed by "timeout <msec>" and by "nowait" to not
+///   wait for its event. The timeout of an action that waits defaults to
+///   twice its estimated time, rounded up to 500 msec. A step times out to
+///   the next step, or to a recovery step with "timeout <msec> -> <label>".
+///   A step is labeled by starting its line with "<label>:", and a label
+///   on a line of its own labels the next step.
+///   The symbols of the step tables are looked up in the robot headers,
+///   by default hotshot.h and shooter.h next to the script file and
+///   drive.h, script.h and sm.h in ../lib. The run time estimates use the
+///   drive and shooter constants of hotshot.h with the motor free speed of
+///   -m (152 RPM by default, as in sim/sim.cpp). A PID drive is estimated
+///   by running the proportional loop against the motor model of the
+///   simulator, with the motion profile of drive.h when DRIVE_PROFILE is
+///   true and the completion tolerance when DRIVE_TOLERANCE is true, so
+///   the estimate leaves out turn scrub, wheel slip, stalls and the
+///   tolerance carried from one move to the next.
+///   The compiler checks that every step waits for events its actions
+///   send, that two actions of a step don't share a subsystem and that the
+///   values fit in the packed table. It prints the estimated time of each
+///   script and writes the tables to the header if one is given. -b also
+///   writes them to a step file for the NXT file system, which the robot
+///   loads at init in place of the tables compiled into the program.
+/// </remarks>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+//
+// Constants.
+//
+#define MAX_LINE_LEN            512
+#define MAX_NAME_LEN            64
+#define MAX_SYMS                512
+#define MAX_DEFS_FILES          8
+#define MAX_SCRIPTS             32
+#define MAX_ROWS                512
+#define MAX_STEP_ACTIONS        4
+#define MAX_TOKENS              32
+#define MAX_LABELS              64
+
+#define DEFAULT_MOTOR_RPM       152.0
+#define MOTOR_TAU               100.0   //in msec
+#define MOTOR_DEADBAND          3
+#define MAX_EST_TIME            30000   //in msec
+#define TIMEOUT_FACTOR          2.0
+#define TIMEOUT_ROUND           500     //in msec
+#define PI                      3.14159265358979323846
+
+#define SUBSYS_NONE             0
+#define SUBSYS_DRIVE            1
+#define SUBSYS_SHOOTER          2
+#define SUBSYS_PICKUP           3
+
+#define EST_DRIVE               0
+#define EST_TURN                1
+#define EST_TIME                2
+#define EST_SPINUP              3
+#define EST_WAIT                4
+
+#define JOIN_NONE               0
+#define JOIN_ALL                1
+#define JOIN_ANY                2
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  char name[MAX_NAME_LEN];
+  char *expr;
+  int  fBusy;
+} SYM;
+
+typedef struct
+{
+  const char *keyword;
+  const char *opName;
+  int         fParam;           //takes a number
+  int         powerDefault;
+  const char *evtTypeName;      //NULL if it sends no event
+  const char *evtIDName;
+  int         subsys;
+  int         est;
+} ACTION;
+
+typedef struct
+{
+  const ACTION *action;
+  int  param;
+  int  power;
+  int  timeout;
+  int  fNoWait;
+  int  fTimeoutSet;
+  const char *label;            //recovery step of the timeout, NULL if none
+  double timeEst;
+} STEP_ACTION;
+
+typedef struct
+{
+  const char *opName;
+  int  flags;                   //0, PARALLEL or JOIN_ANY
+  int  param;
+  int  power;
+  const char *evtTypeName;
+  const char *evtIDName;
+  int  timeout;
+  int  timeoutState;            //0 to time out to the next step
+  char label[MAX_NAME_LEN];     //recovery step of the timeout, "" if none
+  int  lineLabel;
+  char comment[MAX_LINE_LEN];   //source of the step on its first row
+} ROW;
+
+typedef struct
+{
+  char   name[MAX_NAME_LEN];
+  int    iFirstRow;
+  int    nSteps;
+  int    fMirror;
+  double timeEst;
+} SCRIPT;
+
+typedef struct
+{
+  char name[MAX_NAME_LEN];
+  int  iScript;
+  int  iRow;
+} LABEL;
+
+//
+// The actions of the hotshot robot.
+//
+static const ACTION g_Actions[] =
+{
+  {"drive",  "SCROP_DRIVE",  1,  50, "EVTTYPE_DRIVE",   "DRIVEMODE_PID_DISTANCE",
+   SUBSYS_DRIVE,   EST_DRIVE},
+  {"turn",   "SCROP_TURN",   1,  50, "EVTTYPE_DRIVE",   "DRIVEMODE_PID_ANGLE",
+   SUBSYS_DRIVE,   EST_TURN},
+  {"shoot",  "SCROP_SHOOT",  1, 100, "EVTTYPE_SHOOTER", "SHOOTEREVT_SHOOTSTOPPED",
+   SUBSYS_SHOOTER, EST_TIME},
+  {"spinup", "SCROP_SPINUP", 0, 100, "EVTTYPE_SHOOTER", "SHOOTEREVT_SPUNUP",
+   SUBSYS_SHOOTER, EST_SPINUP},
+  {"pickup", "SCROP_PICKUP", 1, 100, "EVTTYPE_SHOOTER", "SHOOTEREVT_PICKUPSTOPPED",
+   SUBSYS_PICKUP,  EST_TIME},
+  {"wait",   "SCROP_WAIT",   1,   0, NULL,              NULL,
+   SUBSYS_NONE,    EST_WAIT}
+};
+
+//
+// Global data.
+//
+static SYM    g_Syms[MAX_SYMS];
+static int    g_NumSyms = 0;
+static ROW    g_Rows[MAX_ROWS];
+static int    g_NumRows = 0;
+static SCRIPT g_Scripts[MAX_SCRIPTS];
+static int    g_NumScripts = 0;
+static LABEL  g_Labels[MAX_LABELS];
+static int    g_NumLabels = 0;
+static const char *g_ScriptPath = NULL;
+static int    g_LineNum = 0;
+static int    g_NumErrors = 0;
+static double g_MotorRPM = DEFAULT_MOTOR_RPM;
+
+/// <summary>
+///   This function reports an error at the current line of the script.
+/// </summary>
+///
+/// <param name="msg">
+///   Specifies the error message.
+/// </param>
+/// <param name="arg">
+///   Specifies the string argument of the message.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+ScriptError(
+  const char *msg,
+  const char *arg
+  )
+{
+  fprintf(stderr, "%s:%d: ", g_ScriptPath, g_LineNum);
+  fprintf(stderr, msg, arg);
+  fputc('\n', stderr);
+  g_NumErrors++;
+
+  return;
+}   //ScriptError
+
+/// <summary>
+///   This function loads the #define lines of a header as symbols. The
+///   first definition of a name wins, as with the #ifndef guards of the
+///   headers. Macros with parameters are skipped.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the header path.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+LoadDefs(
+  const char *path
+  )
+{
+  FILE *file = fopen(path, "r");
+  char line[MAX_LINE_LEN];
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "scrc: cannot open %s\n", path);
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    char *p = line;
+    char *comment;
+    int n = 0;
+    int i;
+
+    while (isspace((unsigned char)*p))
+    {
+      p++;
+    }
+    if (strncmp(p, "#define", 7) != 0)
+    {
+      continue;
+    }
+    p += 7;
+    while (isspace((unsigned char)*p))
+    {
+      p++;
+    }
+    while ((isalnum((unsigned char)p[n]) || (p[n] == '_')) &&
+           (n < MAX_NAME_LEN - 1))
+    {
+      n++;
+    }
+    if ((n == 0) || (p[n] == '(') || (g_NumSyms >= MAX_SYMS))
+    {
+      continue;
+    }
+
+    for (i = 0; i < g_NumSyms; ++i)
+    {
+      if ((strncmp(g_Syms[i].name, p, n) == 0) && (g_Syms[i].name[n] == '\0'))
+      {
+        break;
+      }
+    }
+    if (i < g_NumSyms)
+    {
+      continue;
+    }
+
+    memcpy(g_Syms[g_NumSyms].name, p, n);
+    g_Syms[g_NumSyms].name[n] = '\0';
+    p += n;
+    comment = strstr(p, "//");
+    if (comment != NULL)
+    {
+      *comment = '\0';
+    }
+    g_Syms[g_NumSyms].expr = malloc(strlen(p) + 1);
+    strcpy(g_Syms[g_NumSyms].expr, p);
+    g_Syms[g_NumSyms].fBusy = 0;
+    g_NumSyms++;
+  }
+  fclose(file);
+
+  return 0;
+}   //LoadDefs
+
+static int EvalSym(const char *name, double *value);
+
+/// <summary>
+///   This function skips the white space of an expression.
+/// </summary>
+///
+/// <param name="pp">
+///   Points to the expression pointer.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+SkipSpace(
+  const char **pp
+  )
+{
+  while (isspace((unsigned char)**pp))
+  {
+    (*pp)++;
+  }
+
+  return;
+}   //SkipSpace
+
+static int EvalSum(const char **pp, double *value);
+
+/// <summary>
+///   This function evaluates a number, a symbol, a parenthesized expression
+///   or a negated one.
+/// </summary>
+///
+/// <param name="pp">
+///   Points to the expression pointer.
+/// </param>
+/// <param name="value">
+///   Receives the value.
+/// </param>
+///
+/// <returns> Returns 1 if evaluated, 0 otherwise. </returns>
+
+static int
+EvalTerm(
+  const char **pp,
+  double *value
+  )
+{
+  char name[MAX_NAME_LEN];
+  int n = 0;
+
+  SkipSpace(pp);
+  if (**pp == '(')
+  {
+    (*pp)++;
+    if (!EvalSum(pp, value))
+    {
+      return 0;
+    }
+    SkipSpace(pp);
+    if (**pp != ')')
+    {
+      return 0;
+    }
+    (*pp)++;
+    return 1;
+  }
+  else if (**pp == '-')
+  {
+    (*pp)++;
+    if (!EvalTerm(pp, value))
+    {
+      return 0;
+    }
+    *value = -*value;
+    return 1;
+  }
+  else if (isdigit((unsigned char)**pp) || (**pp == '.'))
+  {
+    char *end;
+
+    if ((**pp == '0') && (((*pp)[1] == 'x') || ((*pp)[1] == 'X')))
+    {
+      *value = (double)strtol(*pp, &end, 16);
+    }
+    else
+    {
+      *value = strtod(*pp, &end);
+    }
+    *pp = end;
+    return 1;
+  }
+
+  while ((isalnum((unsigned char)(*pp)[n]) || ((*pp)[n] == '_')) &&
+         (n < MAX_NAME_LEN - 1))
+  {
+    name[n] = (*pp)[n];
+    n++;
+  }
+  name[n] = '\0';
+  *pp += n;
+
+  return (n > 0) && EvalSym(name, value);
+}   //EvalTerm
+
+/// <summary>
+///   This function evaluates a product of terms.
+/// </summary>
+///
+/// <param name="pp">
+///   Points to the expression pointer.
+/// </param>
+/// <param name="value">
+///   Receives the value.
+/// </param>
+///
+/// <returns> Returns 1 if evaluated, 0 otherwise. </returns>
+
+static int
+EvalProduct(
+  const char **pp,
+  double *value
+  )
+{
+  double rhs;
+
+  if (!EvalTerm(pp, value))
+  {
+    return 0;
+  }
+  for (;;)
+  {
+    SkipSpace(pp);
+    if (**pp == '*')
+    {
+      (*pp)++;
+      if (!EvalTerm(pp, &rhs))
+      {
+        return 0;
+      }
+      *value *= rhs;
+    }
+    else if (**pp == '/')
+    {
+      (*pp)++;
+      if (!EvalTerm(pp, &rhs) || (rhs == 0.0))
+      {
+        return 0;
+      }
+      *value /= rhs;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  return 1;
+}   //EvalProduct
+
+/// <summary>
+///   This function evaluates a sum of products.
+/// </summary>
+///
+/// <param name="pp">
+///   Points to the expression pointer.
+/// </param>
+/// <param name="value">
+///   Receives the value.
+/// </param>
+///
+/// <returns> Returns 1 if evaluated, 0 otherwise. </returns>
+
+static int
+EvalSum(
+  const char **pp,
+  double *value
+  )
+{
+  double rhs;
+
+  if (!EvalProduct(pp, value))
+  {
+    return 0;
+  }
+  for (;;)
+  {
+    SkipSpace(pp);
+    if (**pp == '+')
+    {
+      (*pp)++;
+      if (!EvalProduct(pp, &rhs))
+      {
+        return 0;
+      }
+      *value += rhs;
+    }
+    else if (**pp == '-')
+    {
+      (*pp)++;
+      if (!EvalProduct(pp, &rhs))
+      {
+        return 0;
+      }
+      *value -= rhs;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  return 1;
+}   //EvalSum
+
+/// <summary>
+///   This function evaluates a symbol. PI, true and false are built in
+///   since they are RobotC intrinsics.
+/// </summary>
+///
+/// <param name="name">
+///   Specifies the symbol name.
+/// </param>
+/// <param name="value">
+///   Receives the value.
+/// </param>
+///
+/// <returns> Returns 1 if evaluated, 0 otherwise. </returns>
+
+static int
+EvalSym(
+  const char *name,
+  double *value
+  )
+{
+  int i;
+
+  if (strcmp(name, "PI") == 0)
+  {
+    *value = PI;
+    return 1;
+  }
+  else if ((strcmp(name, "true") == 0) || (strcmp(name, "false") == 0))
+  {
+    *value = (name[0] == 't')? 1.0: 0.0;
+    return 1;
+  }
+
+  for (i = 0; i < g_NumSyms; ++i)
+  {
+    if (strcmp(g_Syms[i].name, name) == 0)
+    {
+      const char *p = g_Syms[i].expr;
+      int fOK;
+
+      if (g_Syms[i].fBusy)
+      {
+        return 0;
+      }
+      g_Syms[i].fBusy = 1;
+      fOK = EvalSum(&p, value);
+      g_Syms[i].fBusy = 0;
+      SkipSpace(&p);
+      return fOK && (*p == '\0');
+    }
+  }
+
+  return 0;
+}   //EvalSym
+
+/// <summary>
+///   This function evaluates a symbol that the compiler depends on and
+///   reports it if it is missing.
+/// </summary>
+///
+/// <param name="name">
+///   Specifies the symbol name.
+/// </param>
+///
+/// <returns> Returns the value of the symbol, 0 if it is missing. </returns>
+
+static double
+RequireSym(
+  const char *name
+  )
+{
+  double value = 0.0;
+
+  if (!EvalSym(name, &value))
+  {
+    fprintf(stderr, "scrc: %s is not defined in the headers\n", name);
+    g_NumErrors++;
+  }
+
+  return value;
+}   //RequireSym
+
+/// <summary>
+///   This function returns the position tolerance of a PID move in clicks
+///   if DRIVE_TOLERANCE is true.
+/// </summary>
+///
+/// <param name="nameTol">
+///   Specifies the symbol of the tolerance.
+/// </param>
+/// <param name="nameClicks">
+///   Specifies the symbol of the clicks per unit of the tolerance.
+/// </param>
+///
+/// <returns> Returns the tolerance in clicks, 0 if none. </returns>
+
+static double
+EstimateTolerance(
+  const char *nameTol,
+  const char *nameClicks
+  )
+{
+  double fTolerance = 0.0;
+
+  if (!EvalSym("DRIVE_TOLERANCE", &fTolerance) || (fTolerance == 0.0))
+  {
+    return 0.0;
+  }
+
+  return (int)(RequireSym(nameTol)*RequireSym(nameClicks));
+}   //EstimateTolerance
+
+/// <summary>
+///   This function estimates the time of a PID drive or turn of the given
+///   number of encoder clicks. It runs the proportional loop of DriveTask
+///   every LOOP_PERIOD against a motor with a first order lag, msec by msec,
+///   until the power drops under 2. If DRIVE_PROFILE is true, the loop
+///   tracks the trapezoidal motion profile of drive.h with the limits
+///   DRIVE_VEL_MAX and DRIVE_ACC_MAX, and the power also sets the cruise
+///   velocity, with the feed-forward of DRIVE_KV and DRIVE_KA if
+///   DRIVE_FEEDFORWARD is true. With a tolerance, the move only ends when
+///   the wheel is within the tolerance of the target and under
+///   DRIVE_TOL_VEL for DRIVE_SETTLE_TIME, also in the tail of the profile,
+///   and not on the power.
+/// </summary>
+///
+/// <param name="clicks">
+///   Specifies the clicks each wheel has to go.
+/// </param>
+/// <param name="power">
+///   Specifies the power limit.
+/// </param>
+/// <param name="tolerance">
+///   Specifies the position tolerance in clicks, 0 if none.
+/// </param>
+///
+/// <returns> Returns the estimated time in msec. </returns>
+
+static double
+EstimatePID(
+  double clicks,
+  int power,
+  double tolerance
+  )
+{
+  double kp = RequireSym("KP");
+  double clicksPerRev = RequireSym("CLICKS_PER_REVOLUTION");
+  int loopPeriod = (int)RequireSym("LOOP_PERIOD");
+  double fProfile = 0.0;
+  double fFeedForward = 0.0;
+  double kV = 0.0;
+  double kA = 0.0;
+  double vel = 0.0;
+  double acc = 0.0;
+  double timeAcc = 0.0;
+  double timeTotal = 0.0;
+  double rpm = 0.0;
+  double rpmTarget;
+  double pos = 0.0;
+  double posPrev = 0.0;
+  double velTolerance = 0.0;
+  double timeSettle = 0.0;
+  int timeOnTarget = -1;
+  int powerMotor = 0;
+  int t;
+
+  power = abs(power);
+  if ((kp <= 0.0) || (power == 0) || (loopPeriod <= 0))
+  {
+    return 0.0;
+  }
+
+  if (EvalSym("DRIVE_PROFILE", &fProfile) && (fProfile != 0.0))
+  {
+    double clicksPerDistance = RequireSym("CLICKS_PER_DISTANCE");
+
+    vel = RequireSym("DRIVE_VEL_MAX")*clicksPerDistance/1000.0*power/100.0;
+    acc = RequireSym("DRIVE_ACC_MAX")*clicksPerDistance/1000000.0;
+    if ((vel > 0.0) && (acc > 0.0))
+    {
+      timeAcc = vel/acc;
+      if (vel*timeAcc > clicks)
+      {
+        timeAcc = sqrt(clicks/acc);
+        vel = acc*timeAcc;
+      }
+      timeTotal = timeAcc + clicks/vel;
+      if (EvalSym("DRIVE_FEEDFORWARD", &fFeedForward) &&
+          (fFeedForward != 0.0))
+      {
+        kV = RequireSym("DRIVE_KV")*1000.0/clicksPerDistance;
+        kA = RequireSym("DRIVE_KA")*1000000.0/clicksPerDistance;
+      }
+    }
+  }
+
+  if (tolerance > 0.0)
+  {
+    velTolerance = RequireSym("DRIVE_TOL_VEL")*
+                   RequireSym("CLICKS_PER_DISTANCE")/1000.0;
+    timeSettle = RequireSym("DRIVE_SETTLE_TIME");
+  }
+
+  for (t = 0; t < MAX_EST_TIME; ++t)
+  {
+    if (t%loopPeriod == 0)
+    {
+      double setpt = clicks;
+      double ff = 0.0;
+      double p;
+
+      if (t < timeAcc)
+      {
+        setpt = acc*t*t/2.0;
+        ff = kV*acc*t + kA*acc;
+      }
+      else if (t < timeTotal - timeAcc)
+      {
+        setpt = vel*(t - timeAcc/2.0);
+        ff = kV*vel;
+      }
+      else if (t < timeTotal)
+      {
+        setpt = clicks - acc*(timeTotal - t)*(timeTotal - t)/2.0;
+        ff = kV*acc*(timeTotal - t) - kA*acc;
+      }
+      p = (int)ff + kp*((int)setpt - (int)pos);
+      powerMotor = (int)((p > power)? power: (p < -power)? -power: p);
+      if ((tolerance == 0.0) && (t >= timeTotal) && (abs(powerMotor) <= 1))
+      {
+        break;
+      }
+      if ((tolerance > 0.0) && (t > 0) &&
+          (fabs(clicks - pos) <= tolerance) &&
+          (fabs(pos - posPrev) <= velTolerance*loopPeriod))
+      {
+        if (timeOnTarget < 0)
+        {
+          timeOnTarget = t;
+        }
+        if (t - timeOnTarget >= timeSettle)
+        {
+          break;
+        }
+      }
+      else
+      {
+        timeOnTarget = -1;
+      }
+      posPrev = pos;
+    }
+    rpmTarget = (abs(powerMotor) <= MOTOR_DEADBAND)?
+                0.0: g_MotorRPM*powerMotor/100.0;
+    rpm += (rpmTarget - rpm)/MOTOR_TAU;
+    pos += rpm*clicksPerRev/60000.0;
+  }
+
+  return t;
+}   //EstimatePID
+
+/// <summary>
+///   This function estimates the time of an action.
+/// </summary>
+///
+/// <param name="sa">
+///   Points to the action of the step.
+/// </param>
+///
+/// <returns> Returns the estimated time in msec. </returns>
+
+static double
+EstimateAction(
+  const STEP_ACTION *sa
+  )
+{
+  double timeEst = 0.0;
+  double step;
+
+  switch (sa->action->est)
+  {
+    case EST_DRIVE:
+      timeEst = EstimatePID(abs(sa->param)*RequireSym("CLICKS_PER_DISTANCE"),
+                            sa->power,
+                            EstimateTolerance("DRIVE_TOL_DISTANCE",
+                                              "CLICKS_PER_DISTANCE"));
+      break;
+
+    case EST_TURN:
+      timeEst = EstimatePID(abs(sa->param)*RequireSym("CLICKS_PER_DEGREE"),
+                            sa->power,
+                            EstimateTolerance("DRIVE_TOL_ANGLE",
+                                              "CLICKS_PER_DEGREE"));
+      break;
+
+    case EST_TIME:
+    case EST_WAIT:
+      timeEst = sa->param;
+      break;
+
+    case EST_SPINUP:
+      step = RequireSym("SHOOTER_POWER_STEP");
+      if (step > 0.0)
+      {
+        timeEst = ceil(abs(sa->power)/step)*RequireSym("SHOOTER_TIME_STEP");
+      }
+      break;
+  }
+
+  return timeEst;
+}   //EstimateAction
+
+/// <summary>
+///   This function looks up an action keyword.
+/// </summary>
+///
+/// <param name="keyword">
+///   Specifies the keyword.
+/// </param>
+///
+/// <returns> Returns the action, NULL if not found. </returns>
+
+static const ACTION *
+FindAction(
+  const char *keyword
+  )
+{
+  int i;
+
+  for (i = 0; i < (int)(sizeof(g_Actions)/sizeof(g_Actions[0])); ++i)
+  {
+    if (strcmp(g_Actions[i].keyword, keyword) == 0)
+    {
+      return &g_Actions[i];
+    }
+  }
+
+  return NULL;
+}   //FindAction
+
+/// <summary>
+///   This function parses an integer token.
+/// </summary>
+///
+/// <param name="token">
+///   Specifies the token.
+/// </param>
+/// <param name="value">
+///   Receives the value.
+/// </param>
+///
+/// <returns> Returns 1 if the token is an integer that fits in an int of
+///           the NXT, 0 otherwise. </returns>
+
+static int
+ParseInt(
+  const char *token,
+  int *value
+  )
+{
+  char *end;
+  long n = strtol(token, &end, 10);
+
+  if ((end == token) || (*end != '\0') || (n < -32768) || (n > 32767))
+  {
+    return 0;
+  }
+  *value = (int)n;
+
+  return 1;
+}   //ParseInt
+
+/// <summary>
+///   This function checks that a token is a valid label name.
+/// </summary>
+///
+/// <param name="token">
+///   Specifies the token.
+/// </param>
+///
+/// <returns> Returns 1 if the token is a label name, 0 otherwise. </returns>
+
+static int
+IsLabel(
+  const char *token
+  )
+{
+  int i;
+
+  if (!isalpha((unsigned char)token[0]) && (token[0] != '_'))
+  {
+    return 0;
+  }
+  for (i = 1; token[i] != '\0'; ++i)
+  {
+    if (!isalnum((unsigned char)token[i]) && (token[i] != '_'))
+    {
+      return 0;
+    }
+  }
+
+  return i < MAX_NAME_LEN;
+}   //IsLabel
+
+/// <summary>
+///   This function adds a row to the step table.
+/// </summary>
+///
+/// <param name="opName">
+///   Specifies the opcode symbol.
+/// </param>
+///
+/// <returns> Returns the row, NULL if the table is full. </returns>
+
+static ROW *
+AddRow(
+  const char *opName
+  )
+{
+  ROW *row;
+
+  if (g_NumRows >= MAX_ROWS)
+  {
+    ScriptError("too many steps%s", "");
+    return NULL;
+  }
+  row = &g_Rows[g_NumRows++];
+  memset(row, 0, sizeof(*row));
+  row->opName = opName;
+  row->evtTypeName = "EVTTYPE_NONE";
+  row->evtIDName = "0";
+
+  return row;
+}   //AddRow
+
+/// <summary>
+///   This function compiles one step of a script.
+/// </summary>
+///
+/// <param name="text">
+///   Specifies the source text of the step.
+/// </param>
+/// <param name="script">
+///   Points to the script the step belongs to.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+CompileStep(
+  const char *text,
+  SCRIPT *script
+  )
+{
+  char buff[MAX_LINE_LEN*2];
+  char *tokens[MAX_TOKENS];
+  int nTokens = 0;
+  STEP_ACTION actions[MAX_STEP_ACTIONS];
+  int nActions = 0;
+  int join = JOIN_NONE;
+  int nWaits = 0;
+  int timeoutStep = 0;
+  const char *label = NULL;
+  double timeStep = -1.0;
+  char *p;
+  int i, j;
+
+  //
+  // Split the step into tokens, '&', '|' and '->' are tokens of their own.
+  //
+  for (i = 0, j = 0; (text[i] != '\0') && (j < (int)sizeof(buff) - 5); ++i)
+  {
+    if ((text[i] == '&') || (text[i] == '|'))
+    {
+      buff[j++] = ' ';
+      buff[j++] = text[i];
+      buff[j++] = ' ';
+    }
+    else if ((text[i] == '-') && (text[i + 1] == '>'))
+    {
+      buff[j++] = ' ';
+      buff[j++] = text[i++];
+      buff[j++] = text[i];
+      buff[j++] = ' ';
+    }
+    else
+    {
+      buff[j++] = text[i];
+    }
+  }
+  buff[j] = '\0';
+  for (p = strtok(buff, " \t\r\n"); p != NULL; p = strtok(NULL, " \t\r\n"))
+  {
+    if (nTokens >= MAX_TOKENS)
+    {
+      ScriptError("step is too long%s", "");
+      return;
+    }
+    tokens[nTokens++] = p;
+  }
+  if (nTokens == 0)
+  {
+    return;
+  }
+
+  //
+  // Parse the actions.
+  //
+  for (i = 0; i < nTokens;)
+  {
+    STEP_ACTION *sa;
+    const ACTION *action = FindAction(tokens[i]);
+
+    if (action == NULL)
+    {
+      ScriptError("unknown action '%s'", tokens[i]);
+      return;
+    }
+    if (nActions >= MAX_STEP_ACTIONS)
+    {
+      ScriptError("too many actions in a step%s", "");
+      return;
+    }
+    sa = &actions[nActions++];
+    memset(sa, 0, sizeof(*sa));
+    sa->action = action;
+    sa->power = action->powerDefault;
+    i++;
+
+    if (action->fParam)
+    {
+      if ((i >= nTokens) || !ParseInt(tokens[i], &sa->param))
+      {
+        ScriptError("%s needs a number", action->keyword);
+        return;
+      }
+      i++;
+    }
+
+    while ((i < nTokens) && (strcmp(tokens[i], "&") != 0) &&
+           (strcmp(tokens[i], "|") != 0))
+    {
+      if ((tokens[i][0] == '@') && (action->est != EST_WAIT))
+      {
+        if (!ParseInt(tokens[i] + 1, &sa->power) ||
+            (sa->power < -100) || (sa->power > 100))
+        {
+          ScriptError("invalid power '%s'", tokens[i]);
+          return;
+        }
+        i++;
+      }
+      else if ((strcmp(tokens[i], "timeout") == 0) && (i + 1 < nTokens))
+      {
+        if (!ParseInt(tokens[i + 1], &sa->timeout) || (sa->timeout < 0))
+        {
+          ScriptError("invalid timeout '%s'", tokens[i + 1]);
+          return;
+        }
+        sa->fTimeoutSet = 1;
+        i += 2;
+        if ((i < nTokens) && (strcmp(tokens[i], "->") == 0))
+        {
+          if ((i + 1 >= nTokens) || !IsLabel(tokens[i + 1]))
+          {
+            ScriptError("'->' needs a label%s", "");
+            return;
+          }
+          if (sa->timeout == 0)
+          {
+            ScriptError("%s can't time out to a label without a timeout",
+                        action->keyword);
+            return;
+          }
+          sa->label = tokens[i + 1];
+          i += 2;
+        }
+      }
+      else if ((strcmp(tokens[i], "nowait") == 0) && (action->est != EST_WAIT))
+      {
+        sa->fNoWait = 1;
+        i++;
+      }
+      else
+      {
+        ScriptError("unexpected '%s'", tokens[i]);
+        return;
+      }
+    }
+
+    if (i < nTokens)
+    {
+      int joinNext = (tokens[i][0] == '&')? JOIN_ALL: JOIN_ANY;
+
+      if ((join != JOIN_NONE) && (join != joinNext))
+      {
+        ScriptError("a step can't mix '&' and '|'%s", "");
+        return;
+      }
+      join = joinNext;
+      i++;
+      if (i >= nTokens)
+      {
+        ScriptError("missing action after '%s'", tokens[i - 1]);
+        return;
+      }
+    }
+  }
+
+  //
+  // Check the event and wait pairing of the actions.
+  //
+  for (i = 0; i < nActions; ++i)
+  {
+    STEP_ACTION *sa = &actions[i];
+
+    if (sa->action->est == EST_WAIT)
+    {
+      if (nActions > 1)
+      {
+        ScriptError("wait can't run in parallel, use a timeout%s", "");
+      }
+      else if (sa->param <= 0)
+      {
+        ScriptError("wait needs a time%s", "");
+      }
+      sa->timeout = sa->param;
+      sa->fNoWait = 1;
+    }
+    else if (!sa->fNoWait && (sa->action->est == EST_TIME) && (sa->param <= 0))
+    {
+      ScriptError("%s without a time never sends its event", sa->action->keyword);
+    }
+
+    for (j = 0; j < i; ++j)
+    {
+      if ((sa->action->subsys != SUBSYS_NONE) &&
+          (sa->action->subsys == actions[j].action->subsys))
+      {
+        ScriptError("%s shares its subsystem with another action of the step",
+                    sa->action->keyword);
+      }
+    }
+
+    sa->timeEst = EstimateAction(sa);
+    if (!sa->fNoWait)
+    {
+      nWaits++;
+      if (!sa->fTimeoutSet)
+      {
+        sa->timeout = (int)(ceil(sa->timeEst*TIMEOUT_FACTOR/TIMEOUT_ROUND)*
+                            TIMEOUT_ROUND);
+      }
+      //
+      // Join all waits for the slowest action, join any for the fastest.
+      //
+      if ((timeStep < 0.0) ||
+          ((join == JOIN_ANY)? (sa->timeEst < timeStep): (sa->timeEst > timeStep)))
+      {
+        timeStep = sa->timeEst;
+      }
+    }
+    if (sa->timeout > 32767)
+    {
+      ScriptError("%s timeout is too long", sa->action->keyword);
+    }
+    if (sa->timeout > timeoutStep)
+    {
+      timeoutStep = sa->timeout;
+    }
+    if (sa->label != NULL)
+    {
+      if ((label != NULL) && (strcmp(label, sa->label) != 0))
+      {
+        ScriptError("a step can only time out to one label%s", "");
+      }
+      label = sa->label;
+    }
+  }
+  if ((join == JOIN_ANY) && (nWaits == 0))
+  {
+    ScriptError("'|' step has no action to wait for%s", "");
+  }
+  if (timeStep < 0.0)
+  {
+    timeStep = (timeoutStep > 0)? timeoutStep: 0.0;
+  }
+
+  //
+  // Emit the rows, the last one ends the step.
+  //
+  for (i = 0; i < nActions; ++i)
+  {
+    STEP_ACTION *sa = &actions[i];
+    ROW *row = AddRow(sa->action->opName);
+
+    if (row == NULL)
+    {
+      return;
+    }
+    if (i == 0)
+    {
+      snprintf(row->comment, sizeof(row->comment), "%s (%.1f sec)",
+               text, timeStep/1000.0);
+    }
+    row->flags = (i < nActions - 1)? 1: (join == JOIN_ANY)? 2: 0;
+    row->param = sa->param;
+    row->power = (sa->action->est == EST_WAIT)? 0: sa->power;
+    if (!sa->fNoWait)
+    {
+      row->evtTypeName = sa->action->evtTypeName;
+      row->evtIDName = sa->action->evtIDName;
+    }
+    row->timeout = sa->timeout;
+    if (sa->label != NULL)
+    {
+      strcpy(row->label, sa->label);
+      row->lineLabel = g_LineNum;
+    }
+  }
+  script->nSteps++;
+  script->timeEst += timeStep;
+
+  return;
+}   //CompileStep
+
+/// <summary>
+///   This function labels the next step of a script.
+/// </summary>
+///
+/// <param name="name">
+///   Specifies the label.
+/// </param>
+/// <param name="script">
+///   Points to the script the step belongs to.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+AddLabel(
+  const char *name,
+  SCRIPT *script
+  )
+{
+  int iScript = (int)(script - g_Scripts);
+  int i;
+
+  for (i = 0; i < g_NumLabels; ++i)
+  {
+    if ((g_Labels[i].iScript == iScript) &&
+        (strcmp(g_Labels[i].name, name) == 0))
+    {
+      ScriptError("label '%s' is already defined", name);
+      return;
+    }
+  }
+  if (g_NumLabels >= MAX_LABELS)
+  {
+    ScriptError("too many labels%s", "");
+    return;
+  }
+  strcpy(g_Labels[g_NumLabels].name, name);
+  g_Labels[g_NumLabels].iScript = iScript;
+  g_Labels[g_NumLabels].iRow = g_NumRows;
+  g_NumLabels++;
+
+  return;
+}   //AddLabel
+
+/// <summary>
+///   This function sets the timeout state of the rows of a script that time
+///   out to a label. The state of a step is SMSTATE_STARTED plus the offset
+///   of its first row in the script, as ScriptState in lib/script.h has it.
+/// </summary>
+///
+/// <param name="script">
+///   Points to the script.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+ResolveLabels(
+  SCRIPT *script
+  )
+{
+  int iScript = (int)(script - g_Scripts);
+  int lineNum = g_LineNum;
+  int i, j;
+
+  for (i = script->iFirstRow; i < g_NumRows; ++i)
+  {
+    ROW *row = &g_Rows[i];
+
+    if (row->label[0] == '\0')
+    {
+      continue;
+    }
+    for (j = 0; j < g_NumLabels; ++j)
+    {
+      if ((g_Labels[j].iScript == iScript) &&
+          (strcmp(g_Labels[j].name, row->label) == 0))
+      {
+        break;
+      }
+    }
+    if (j < g_NumLabels)
+    {
+      row->timeoutState = (int)RequireSym("SMSTATE_STARTED") +
+                          g_Labels[j].iRow - script->iFirstRow;
+    }
+    else
+    {
+      g_LineNum = row->lineLabel;
+      ScriptError("unknown label '%s'", row->label);
+      g_LineNum = lineNum;
+    }
+  }
+
+  return;
+}   //ResolveLabels
+
+/// <summary>
+///   This function compiles a script file.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the script file path.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+CompileFile(
+  const char *path
+  )
+{
+  FILE *file = fopen(path, "r");
+  char line[MAX_LINE_LEN];
+  SCRIPT *script = NULL;
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "scrc: cannot open %s\n", path);
+    return -1;
+  }
+
+  g_ScriptPath = path;
+  g_LineNum = 0;
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    char *p = strchr(line, '#');
+    char *step;
+    char name[MAX_NAME_LEN];
+    char option[16];
+    char extra[2];
+    int i;
+
+    g_LineNum++;
+    if (p != NULL)
+    {
+      *p = '\0';
+    }
+    p = line;
+    while (isspace((unsigned char)*p))
+    {
+      p++;
+    }
+    if (*p == '\0')
+    {
+      continue;
+    }
+
+    if ((strncmp(p, "script", 6) == 0) && isspace((unsigned char)p[6]))
+    {
+      int n = sscanf(p + 6, "%63s %15s %1s", name, option, extra);
+
+      if (script != NULL)
+      {
+        ScriptError("script %s has no end", script->name);
+      }
+      if ((n < 1) || (n > 2) || ((n == 2) && (strcmp(option, "mirror") != 0)))
+      {
+        ScriptError("expected 'script <name> [mirror]'%s", "");
+        script = NULL;
+        continue;
+      }
+      if (g_NumScripts >= MAX_SCRIPTS)
+      {
+        ScriptError("too many scripts%s", "");
+        break;
+      }
+      for (i = 0; name[i] != '\0'; ++i)
+      {
+        if (!isalnum((unsigned char)name[i]) && (name[i] != '_'))
+        {
+          ScriptError("invalid script name '%s'", name);
+          break;
+        }
+      }
+      script = &g_Scripts[g_NumScripts++];
+      memset(script, 0, sizeof(*script));
+      strcpy(script->name, name);
+      script->iFirstRow = g_NumRows;
+      script->fMirror = (n == 2);
+      continue;
+    }
+    else if ((strncmp(p, "end", 3) == 0) &&
+             ((p[3] == '\0') || isspace((unsigned char)p[3])))
+    {
+      if (script == NULL)
+      {
+        ScriptError("end without a script%s", "");
+      }
+      else if (AddRow("SCROP_END") != NULL)
+      {
+        snprintf(g_Rows[g_NumRows - 1].comment,
+                 sizeof(g_Rows[g_NumRows - 1].comment), "end");
+        ResolveLabels(script);
+        script = NULL;
+      }
+      continue;
+    }
+    else if (script == NULL)
+    {
+      ScriptError("step outside of a script%s", "");
+      continue;
+    }
+
+    //
+    // A label labels the step after it, on the same line or the next one.
+    //
+    i = 0;
+    while (isalnum((unsigned char)p[i]) || (p[i] == '_'))
+    {
+      i++;
+    }
+    if ((i > 0) && (p[i] == ':'))
+    {
+      p[i] = '\0';
+      if (IsLabel(p))
+      {
+        AddLabel(p, script);
+      }
+      else
+      {
+        ScriptError("invalid label '%s'", p);
+      }
+      p += i + 1;
+    }
+
+    //
+    // CompileStep tokenizes with strtok, so the steps are split by hand.
+    //
+    for (step = p; step != NULL; step = p)
+    {
+      char text[MAX_LINE_LEN];
+      int n;
+
+      p = strchr(step, ';');
+      if (p != NULL)
+      {
+        *p++ = '\0';
+      }
+      while (isspace((unsigned char)*step))
+      {
+        step++;
+      }
+      strncpy(text, step, sizeof(text) - 1);
+      text[sizeof(text) - 1] = '\0';
+      n = (int)strlen(text);
+      while ((n > 0) && isspace((unsigned char)text[n - 1]))
+      {
+        text[--n] = '\0';
+      }
+      if (n > 0)
+      {
+        CompileStep(text, script);
+      }
+    }
+  }
+  fclose(file);
+
+  if (script != NULL)
+  {
+    ScriptError("script %s has no end", script->name);
+  }
+
+  return 0;
+}   //CompileFile
+
+/// <summary>
+///   This function checks that a symbol of the step table is defined and
+///   that its value is in range.
+/// </summary>
+///
+/// <param name="name">
+///   Specifies the symbol name.
+/// </param>
+/// <param name="maxValue">
+///   Specifies the largest value that fits in its field.
+/// </param>
+///
+/// <returns> Returns the value of the symbol, 0 if it is missing. </returns>
+
+static int
+CheckSym(
+  const char *name,
+  int maxValue
+  )
+{
+  const char *p = name;
+  double value = 0.0;
+
+  if (!EvalSum(&p, &value) || (*p != '\0'))
+  {
+    fprintf(stderr, "scrc: %s is not defined in the headers\n", name);
+    g_NumErrors++;
+  }
+  else if ((value < 0.0) || (value > maxValue))
+  {
+    fprintf(stderr, "scrc: %s is %g, it doesn't fit in the step table\n",
+            name, value);
+    g_NumErrors++;
+  }
+
+  return (int)value;
+}   //CheckSym
+
+/// <summary>
+///   This function returns the estimated time of a script in msec as it is
+///   stored in the step tables.
+/// </summary>
+///
+/// <param name="script">
+///   Points to the script.
+/// </param>
+///
+/// <returns> Returns the estimated time in msec. </returns>
+
+static int
+ScriptTime(
+  const SCRIPT *script
+  )
+{
+  return (script->timeEst < 32767.0)? (int)(script->timeEst + 0.5): 32767;
+}   //ScriptTime
+
+/// <summary>
+///   This function writes a little endian short to a file.
+/// </summary>
+///
+/// <param name="file">
+///   Specifies the file.
+/// </param>
+/// <param name="value">
+///   Specifies the value.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+WriteShort(
+  FILE *file,
+  int value
+  )
+{
+  fputc(value & 0xff, file);
+  fputc((value >> 8) & 0xff, file);
+
+  return;
+}   //WriteShort
+
+/// <summary>
+///   This function writes the step tables to a step file that the robot
+///   loads with ScriptLibLoad (see lib/script.h for the layout). The
+///   symbols are resolved to their values in the headers.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the step file path.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+WriteStepFile(
+  const char *path
+  )
+{
+  int rowSize = (int)RequireSym("SCRSTEP_SIZE");
+  int nameLen = (int)RequireSym("SCRLIB_NAME_LEN");
+  int flagParallel = (int)RequireSym("SCROPF_PARALLEL");
+  int flagJoinAny = (int)RequireSym("SCROPF_JOIN_ANY");
+  int flagMirror = (int)RequireSym("SCRF_MIRROR");
+  FILE *file;
+  int i, j;
+
+  //
+  // The robot can only load what fits in its SCRLIB.
+  //
+  if (rowSize != 5)
+  {
+    fprintf(stderr, "scrc: SCRSTEP_SIZE is %d, expected 5\n", rowSize);
+    g_NumErrors++;
+  }
+  if (g_NumScripts > RequireSym("MAX_SCRLIB_ROUTINES"))
+  {
+    fprintf(stderr, "scrc: %d scripts, MAX_SCRLIB_ROUTINES is too small\n",
+            g_NumScripts);
+    g_NumErrors++;
+  }
+  if (g_NumRows*rowSize > RequireSym("SCRLIB_SIZE"))
+  {
+    fprintf(stderr, "scrc: %d ints, SCRLIB_SIZE is too small\n",
+            g_NumRows*rowSize);
+    g_NumErrors++;
+  }
+  for (i = 0; i < g_NumScripts; ++i)
+  {
+    if ((int)strlen(g_Scripts[i].name) >= nameLen)
+    {
+      fprintf(stderr, "scrc: script name %s is too long for the step file\n",
+              g_Scripts[i].name);
+      g_NumErrors++;
+    }
+  }
+  if (g_NumErrors > 0)
+  {
+    return -1;
+  }
+
+  file = fopen(path, "wb");
+  if (file == NULL)
+  {
+    fprintf(stderr, "scrc: cannot create %s\n", path);
+    return -1;
+  }
+
+  WriteShort(file, (int)RequireSym("SCRLIB_MAGIC"));
+  fputc((int)RequireSym("SCRLIB_VERSION"), file);
+  fputc(rowSize, file);
+  WriteShort(file, g_NumScripts);
+  WriteShort(file, g_NumRows*rowSize);
+  for (i = 0; i < g_NumScripts; ++i)
+  {
+    for (j = 0; j < nameLen; ++j)
+    {
+      fputc((j < (int)strlen(g_Scripts[i].name))? g_Scripts[i].name[j]: 0,
+            file);
+    }
+    WriteShort(file, g_Scripts[i].iFirstRow*rowSize);
+    WriteShort(file, g_Scripts[i].fMirror? flagMirror: 0);
+    WriteShort(file, ScriptTime(&g_Scripts[i]));
+  }
+  for (i = 0; i < g_NumRows; ++i)
+  {
+    ROW *row = &g_Rows[i];
+
+    WriteShort(file, CheckSym(row->opName, 0xff) |
+                     ((row->flags == 1)? flagParallel:
+                      (row->flags == 2)? flagJoinAny: 0));
+    WriteShort(file, row->param);
+    WriteShort(file, (row->power & 0xff) |
+                     (CheckSym(row->evtTypeName, 0x0f) << 8) |
+                     (CheckSym(row->evtIDName, 0x07) << 12));
+    WriteShort(file, row->timeout);
+    WriteShort(file, row->timeoutState);
+  }
+  fclose(file);
+
+  return 0;
+}   //WriteStepFile
+
+/// <summary>
+///   This function writes the step tables to a header.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the header path.
+/// </param>
+/// <param name="scriptPath">
+///   Specifies the script file path for the header comment.
+/// </param>
+///
+/// <returns> Success: Returns 0. </returns>
+/// <returns> Failure: Returns -1. </returns>
+
+static int
+WriteHeader(
+  const char *path,
+  const char *scriptPath
+  )
+{
+  FILE *file = fopen(path, "w");
+  const char *moduleName = strrchr(path, '/');
+  const char *scriptName = strrchr(scriptPath, '/');
+  int iScript = 0;
+  int i, j;
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "scrc: cannot create %s\n", path);
+    return -1;
+  }
+  moduleName = (moduleName != NULL)? moduleName + 1: path;
+  scriptName = (scriptName != NULL)? scriptName + 1: scriptPath;
+
+  fprintf(file,
+          "#if 0\n"
+          "/// Copyright (c) Titan Robotics Club. All rights reserved.\n"
+          "///\n"
+          "/// <module name=\"%s\" />\n"
+          "///\n"
+          "/// <summary>\n"
+          "///   This module contains the autonomous step tables compiled from\n"
+          "///   %s (generated by tools/scrc.c, do not edit).\n"
+          "/// </summary>\n"
+          "///\n"
+          "/// <remarks>\n"
+          "///   Environment: RobotC for Lego Mindstorms NXT.\n"
+          "///   The rows are packed as in lib/script.h, %d bytes in all.\n"
+          "/// </remarks>\n"
+          "#endif\n"
+          "\n"
+          "#define NUM_AUTOSCRIPTS         %d\n"
+          "\n",
+          moduleName, scriptName,
+          g_NumRows*(int)RequireSym("SCRSTEP_SIZE")*2, g_NumScripts);
+
+  fprintf(file, "string g_AutoNames[NUM_AUTOSCRIPTS] =\n{\n");
+  for (i = 0; i < g_NumScripts; ++i)
+  {
+    fprintf(file, "  \"%s\"%s\n",
+            g_Scripts[i].name, (i < g_NumScripts - 1)? ",": "");
+  }
+  fprintf(file, "};\n\nint g_AutoFlags[NUM_AUTOSCRIPTS] =\n{\n");
+  for (i = 0; i < g_NumScripts; ++i)
+  {
+    fprintf(file, "  %s%s\n",
+            g_Scripts[i].fMirror? "SCRF_MIRROR": "0",
+            (i < g_NumScripts - 1)? ",": "");
+  }
+  fprintf(file, "};\n\nint g_AutoTimes[NUM_AUTOSCRIPTS] =   //in msec\n{\n");
+  for (i = 0; i < g_NumScripts; ++i)
+  {
+    fprintf(file, "  %d%s\n",
+            ScriptTime(&g_Scripts[i]), (i < g_NumScripts - 1)? ",": "");
+  }
+  fprintf(file, "};\n\nint g_AutoSteps[] =\n{\n");
+
+  for (i = 0; i < g_NumRows; ++i)
+  {
+    ROW *row = &g_Rows[i];
+    char op[MAX_NAME_LEN*2];
+    char wait[MAX_NAME_LEN*3];
+
+    if ((iScript < g_NumScripts) && (g_Scripts[iScript].iFirstRow == i))
+    {
+      fprintf(file,
+              "  //\n"
+              "  // %s: %d steps, about %.1f sec.\n"
+              "  //\n",
+              g_Scripts[iScript].name, g_Scripts[iScript].nSteps,
+              g_Scripts[iScript].timeEst/1000.0);
+      iScript++;
+    }
+    for (j = 0; j < g_NumLabels; ++j)
+    {
+      if (g_Labels[j].iRow == i)
+      {
+        fprintf(file, "  // %s:\n", g_Labels[j].name);
+      }
+    }
+    if (row->comment[0] != '\0')
+    {
+      fprintf(file, "  // %s\n", row->comment);
+    }
+    snprintf(op, sizeof(op), "%s%s,", row->opName,
+             (row->flags == 1)? " | SCROPF_PARALLEL":
+             (row->flags == 2)? " | SCROPF_JOIN_ANY": "");
+    snprintf(wait, sizeof(wait), "SCRWAIT(%d, %s, %s),",
+             row->power, row->evtTypeName, row->evtIDName);
+    fprintf(file, "  %-31s %5d, %-57s %5d, %3d%s\n",
+            op, row->param, wait, row->timeout, row->timeoutState,
+            (i < g_NumRows - 1)? ",": "");
+  }
+  fprintf(file, "};\n");
+  fclose(file);
+
+  return 0;
+}   //WriteHeader
+
+int
+main(
+  int argc,
+  char *argv[]
+  )
+{
+  const char *defsFiles[MAX_DEFS_FILES];
+  int nDefsFiles = 0;
+  const char *scriptPath = NULL;
+  const char *headerPath = NULL;
+  const char *stepPath = NULL;
+  static char defaultDefs[5][MAX_LINE_LEN];
+  static const char *defaultNames[5] =
+  {
+    "hotshot.h", "shooter.h", "../lib/drive.h", "../lib/script.h",
+    "../lib/sm.h"
+  };
+  int i;
+
+  for (i = 1; i < argc; ++i)
+  {
+    if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+    {
+      g_MotorRPM = atof(argv[++i]);
+    }
+    else if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc) &&
+             (nDefsFiles < MAX_DEFS_FILES))
+    {
+      defsFiles[nDefsFiles++] = argv[++i];
+    }
+    else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc))
+    {
+      stepPath = argv[++i];
+    }
+    else if ((argv[i][0] != '-') && (scriptPath == NULL))
+    {
+      scriptPath = argv[i];
+    }
+    else if ((argv[i][0] != '-') && (headerPath == NULL))
+    {
+      headerPath = argv[i];
+    }
+    else
+    {
+      scriptPath = NULL;
+      break;
+    }
+  }
+  if ((scriptPath == NULL) || (g_MotorRPM <= 0.0))
+  {
+    fprintf(stderr,
+            "Usage: %s [-m motorRPM] [-d defsFile]... [-b stepFile] "
+            "script.scr [header.h]\n",
+            argv[0]);
+    return 2;
+  }
+
+  if (nDefsFiles == 0)
+  {
+    const char *slash = strrchr(scriptPath, '/');
+    int lenDir = (slash != NULL)? (int)(slash - scriptPath) + 1: 0;
+
+    for (i = 0; i < 5; ++i)
+    {
+      snprintf(defaultDefs[i], sizeof(defaultDefs[i]), "%.*s%s",
+               lenDir, scriptPath, defaultNames[i]);
+      defsFiles[nDefsFiles++] = defaultDefs[i];
+    }
+  }
+  for (i = 0; i < nDefsFiles; ++i)
+  {
+    if (LoadDefs(defsFiles[i]) != 0)
+    {
+      return 1;
+    }
+  }
+
+  if (CompileFile(scriptPath) != 0)
+  {
+    return 1;
+  }
+
+  //
+  // The packed rows have 4 bits for the event type and 3 for the event ID
+  // so that the wait column stays a positive int.
+  //
+  for (i = 0; i < g_NumRows; ++i)
+  {
+    CheckSym(g_Rows[i].opName, 0xff);
+    CheckSym(g_Rows[i].evtTypeName, 0x0f);
+    CheckSym(g_Rows[i].evtIDName, 0x07);
+  }
+  if (g_NumErrors > 0)
+  {
+    fprintf(stderr, "scrc: %d error(s)\n", g_NumErrors);
+    return 1;
+  }
+
+  for (i = 0; i < g_NumScripts; ++i)
+  {
+    printf("%s: %d steps, about %.1f sec\n",
+           g_Scripts[i].name, g_Scripts[i].nSteps,
+           g_Scripts[i].timeEst/1000.0);
+  }
+  printf("%d scripts, %d rows, %d bytes\n",
+         g_NumScripts, g_NumRows,
+         g_NumRows*(int)RequireSym("SCRSTEP_SIZE")*2);
+
+  if ((stepPath != NULL) && (WriteStepFile(stepPath) != 0))
+  {
+    return 1;
+  }
+
+  return ((headerPath != NULL) && (WriteHeader(headerPath, scriptPath) != 0))?
+         1: 0;
+}   //main
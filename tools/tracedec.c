@@ -0,0 +1,739 @@
+#if 0
+/// Copyright (c) Michael Tsang. All rights reserved.
+///
+/// <module name="tracedec.c" />
+///
+/// <summary>
+///   This module contains the host side decoder for the binary trace
+///   records written by lib/trace.h when _TRACE_BINARY is defined.
+/// </summary>
+///
+/// <remarks>
+///   Environment: Linux host, standard C.
+///   Build: cc -o tracedec tools/tracedec.c
+///   Usage: tracedec [-t] <logfile> <source files...>
+///   The log file is the saved RobotC debug stream. Only lines starting
+///   with '@' are decoded, everything else is passed through. A record is
+///   '@' and eight 16-bit words in hex, laid out as TraceTask writes them.
+///   The records refer to the trace points by function ID and by line from
+///   the TFuncId of the function, so the functions in the source files must
+///   be the ones the program was compiled from, along with the FID_ and
+///   FIDBASE_ definitions of their modules.
+/// </remarks>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+//
+// Constants.
+//
+#define MAX_FILES               64
+#define MAX_SYMS                1024
+#define MAX_FUNCS               512
+#define MAX_LINE_LEN            512
+#define MAX_NAME_LEN            64
+
+#define REC_WORDS               8
+#define FIDBASE_MAIN            0x0140
+#define MAX_MOD_FUNCS           32
+
+#define TRACEREC_ENTER          0
+#define TRACEREC_EXIT           1
+#define TRACEREC_MSG            2
+
+//
+// Type definitions.
+//
+typedef struct
+{
+  char name[MAX_NAME_LEN];
+  char expr[MAX_NAME_LEN];
+  long value;
+  int  fResolved;
+} SYM;
+
+typedef struct
+{
+  const char *path;
+  int   numLines;
+  char  **lines;
+} SRCFILE;
+
+typedef struct
+{
+  char    fidName[MAX_NAME_LEN];
+  long    idFunc;
+  SRCFILE *src;
+  int     line;
+} FUNC;
+
+//
+// Global data.
+//
+static SYM     g_Syms[MAX_SYMS];
+static int     g_NumSyms = 0;
+static SRCFILE g_Files[MAX_FILES];
+static int     g_NumFiles = 0;
+static FUNC    g_Funcs[MAX_FUNCS];
+static int     g_NumFuncs = 0;
+static int     g_IndentLevel = 0;
+static int     g_fTimestamp = 0;
+
+static const char *g_MsgNames[] =
+{
+  "_Fatal:", "_Err:", "_Warn:", "_Info:", "_Verbose:"
+};
+
+/// <summary>
+///   This function looks up the value of a FID_ or FIDBASE_ symbol.
+/// </summary>
+///
+/// <param name="name">
+///   Specifies the symbol name.
+/// </param>
+/// <param name="value">
+///   Receives the symbol value.
+/// </param>
+///
+/// <returns> Returns 1 if found, 0 otherwise. </returns>
+
+static int
+LookupSym(
+  const char *name,
+  long *value
+  )
+{
+  int i;
+
+  for (i = 0; i < g_NumSyms; ++i)
+  {
+    if (g_Syms[i].fResolved && (strcmp(g_Syms[i].name, name) == 0))
+    {
+      *value = g_Syms[i].value;
+      return 1;
+    }
+  }
+
+  return 0;
+}   //LookupSym
+
+/// <summary>
+///   This function evaluates the right hand side of a FID_ or FIDBASE_
+///   definition. It understands numbers, TGenFidBase(n), symbols and a
+///   symbol plus a number, as genfid.c writes them.
+/// </summary>
+///
+/// <param name="expr">
+///   Specifies the expression text.
+/// </param>
+/// <param name="value">
+///   Receives the value.
+/// </param>
+///
+/// <returns> Returns 1 if evaluated, 0 otherwise. </returns>
+
+static int
+EvalExpr(
+  const char *expr,
+  long *value
+  )
+{
+  char name[MAX_NAME_LEN];
+  int n = 0;
+  int offset = 0;
+
+  while (isspace((unsigned char)*expr) || (*expr == '('))
+  {
+    expr++;
+  }
+
+  if (isdigit((unsigned char)*expr))
+  {
+    *value = strtol(expr, NULL, 0);
+    return 1;
+  }
+  else if (sscanf(expr, "TGenFidBase(%d)", &n) == 1)
+  {
+    *value = FIDBASE_MAIN + n*MAX_MOD_FUNCS;
+    return 1;
+  }
+
+  n = 0;
+  while ((isalnum((unsigned char)expr[n]) || (expr[n] == '_')) &&
+         (n < MAX_NAME_LEN - 1))
+  {
+    name[n] = expr[n];
+    n++;
+  }
+  name[n] = '\0';
+  sscanf(expr + n, " + %d", &offset);
+
+  if ((n > 0) && LookupSym(name, value))
+  {
+    *value += offset;
+    return 1;
+  }
+
+  return 0;
+}   //EvalExpr
+
+/// <summary>
+///   This function loads a source file and collects its FID_ and FIDBASE_
+///   definitions and the TFuncId of each function.
+/// </summary>
+///
+/// <param name="path">
+///   Specifies the path of the source file.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+LoadSource(
+  const char *path
+  )
+{
+  FILE *file = fopen(path, "r");
+  char buff[MAX_LINE_LEN];
+  SRCFILE *src;
+  int maxLines = 0;
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "tracedec: cannot open %s\n", path);
+    exit(1);
+  }
+  else if (g_NumFiles >= MAX_FILES)
+  {
+    fprintf(stderr, "tracedec: too many source files\n");
+    exit(1);
+  }
+
+  src = &g_Files[g_NumFiles++];
+  src->path = path;
+  src->numLines = 0;
+  src->lines = NULL;
+
+  while (fgets(buff, sizeof(buff), file) != NULL)
+  {
+    char name[MAX_NAME_LEN];
+    char rest[MAX_NAME_LEN];
+    char *p;
+
+    if (src->numLines >= maxLines)
+    {
+      maxLines = maxLines? maxLines*2: 256;
+      src->lines = realloc(src->lines, maxLines*sizeof(char *));
+    }
+    src->lines[src->numLines] = malloc(strlen(buff) + 1);
+    strcpy(src->lines[src->numLines++], buff);
+
+    if ((sscanf(buff, " #define %63s %63[^\n]", name, rest) == 2) &&
+        ((strncmp(name, "FID_", 4) == 0) ||
+         (strncmp(name, "FIDBASE_", 8) == 0)) &&
+        (g_NumSyms < MAX_SYMS))
+    {
+      //
+      // The definitions are evaluated once all the files are loaded since
+      // the bases may be defined in a file that comes later.
+      //
+      strcpy(g_Syms[g_NumSyms].name, name);
+      strcpy(g_Syms[g_NumSyms].expr, rest);
+      g_Syms[g_NumSyms].fResolved = 0;
+      g_NumSyms++;
+    }
+    else if (((p = strstr(buff, "TFuncId(")) != NULL) &&
+             (strstr(buff, "#define") == NULL) &&
+             (sscanf(p + strlen("TFuncId("), "%63[A-Za-z0-9_]", name) == 1) &&
+             (g_NumFuncs < MAX_FUNCS))
+    {
+      strcpy(g_Funcs[g_NumFuncs].fidName, name);
+      g_Funcs[g_NumFuncs].idFunc = -1;
+      g_Funcs[g_NumFuncs].src = src;
+      g_Funcs[g_NumFuncs].line = src->numLines;
+      g_NumFuncs++;
+    }
+  }
+  fclose(file);
+
+  return;
+}   //LoadSource
+
+/// <summary>
+///   This function evaluates the FID_ and FIDBASE_ definitions and the
+///   function ID of each function. A definition is evaluated once the
+///   symbols it uses are, so it takes a pass for each level of definitions.
+/// </summary>
+///
+/// <returns> None. </returns>
+
+static void
+ResolveFuncs(void)
+{
+  int fProgress = 1;
+  int i;
+
+  while (fProgress)
+  {
+    fProgress = 0;
+    for (i = 0; i < g_NumSyms; ++i)
+    {
+      if (!g_Syms[i].fResolved &&
+          EvalExpr(g_Syms[i].expr, &g_Syms[i].value))
+      {
+        g_Syms[i].fResolved = 1;
+        fProgress = 1;
+      }
+    }
+  }
+
+  for (i = 0; i < g_NumFuncs; ++i)
+  {
+    LookupSym(g_Funcs[i].fidName, &g_Funcs[i].idFunc);
+  }
+
+  return;
+}   //ResolveFuncs
+
+/// <summary>
+///   This function finds the function of a function ID.
+/// </summary>
+///
+/// <param name="idFunc">
+///   Specifies the function ID.
+/// </param>
+///
+/// <returns> Returns the function or NULL if not found. </returns>
+
+static FUNC *
+FindFunc(
+  long idFunc
+  )
+{
+  int i;
+
+  for (i = 0; i < g_NumFuncs; ++i)
+  {
+    if (g_Funcs[i].idFunc == idFunc)
+    {
+      return &g_Funcs[i];
+    }
+  }
+
+  return NULL;
+}   //FindFunc
+
+/// <summary>
+///   This function finds the name of the function containing the given
+///   line, which is the nearest function header at or above the line. A
+///   function header starts in column 0 with the function name followed by
+///   '(', or with "task" for RobotC tasks.
+/// </summary>
+///
+/// <param name="src">
+///   Specifies the source file.
+/// </param>
+/// <param name="line">
+///   Specifies the line number (1-based).
+/// </param>
+/// <param name="name">
+///   Receives the function name.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+FindFuncName(
+  SRCFILE *src,
+  int line,
+  char *name
+  )
+{
+  int i;
+
+  strcpy(name, "?");
+  for (i = line - 1; (i >= 0) && (i < src->numLines); --i)
+  {
+    char *p = src->lines[i];
+    int n = 0;
+
+    if (strncmp(p, "task ", 5) == 0)
+    {
+      p += 5;
+    }
+
+    if ((sscanf(p, "%63[A-Za-z0-9_]%n", name, &n) == 1) &&
+        !isdigit((unsigned char)p[0]) && (p[n] == '('))
+    {
+      break;
+    }
+    strcpy(name, "?");
+  }
+
+  return;
+}   //FindFuncName
+
+/// <summary>
+///   This function finds the format string of a trace point. Trace points
+///   may span lines, so a few lines above are searched as well.
+/// </summary>
+///
+/// <param name="src">
+///   Specifies the source file.
+/// </param>
+/// <param name="line">
+///   Specifies the line number (1-based).
+/// </param>
+/// <param name="fmt">
+///   Receives the format string.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+FindFormat(
+  SRCFILE *src,
+  int line,
+  char *fmt
+  )
+{
+  int i;
+
+  fmt[0] = '\0';
+  for (i = line - 1; (i >= 0) && (i >= line - 4) && (i < src->numLines); --i)
+  {
+    char *p = strstr(src->lines[i], "(\"");
+
+    if (p != NULL)
+    {
+      sscanf(p + 2, "%511[^\"]", fmt);
+      break;
+    }
+  }
+
+  return;
+}   //FindFormat
+
+/// <summary>
+///   This function prints a trace message by applying the int arguments to
+///   the format string. The robot records the args of float conversions
+///   scaled by 10 to the power of their precision (TFloat), so they are
+///   scaled back here. Other conversions are printed as integers since the
+///   robot only recorded ints.
+/// </summary>
+///
+/// <param name="fmt">
+///   Specifies the format string.
+/// </param>
+/// <param name="args">
+///   Specifies the arguments.
+/// </param>
+/// <param name="nArgs">
+///   Specifies the number of arguments.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+PrintFormat(
+  const char *fmt,
+  const long *args,
+  int nArgs
+  )
+{
+  int iArg = 0;
+
+  while (*fmt != '\0')
+  {
+    if (*fmt != '%')
+    {
+      putchar(*fmt++);
+    }
+    else if (fmt[1] == '%')
+    {
+      putchar('%');
+      fmt += 2;
+    }
+    else
+    {
+      char spec[32];
+      int n = 0;
+
+      spec[n++] = *fmt++;
+      while ((*fmt != '\0') && (strchr("-+ #0123456789.", *fmt) != NULL) &&
+             (n < (int)sizeof(spec) - 3))
+      {
+        spec[n++] = *fmt++;
+      }
+      while ((*fmt == 'l') || (*fmt == 'h'))
+      {
+        fmt++;
+      }
+
+      if (*fmt == '\0')
+      {
+        break;
+      }
+      else if (iArg >= nArgs)
+      {
+        fputs("?", stdout);
+      }
+      else if (strchr("dixXuc", *fmt) != NULL)
+      {
+        spec[n++] = 'l';
+        spec[n++] = (*fmt == 'c')? 'd': *fmt;
+        spec[n] = '\0';
+        //
+        // The args are 16-bit ints on the robot.
+        //
+        printf(spec, (strchr("xXu", *fmt) != NULL)? args[iArg] & 0xffff:
+                                                    args[iArg]);
+      }
+      else if (strchr("feEgG", *fmt) != NULL)
+      {
+        char *dot;
+        double value = (double)args[iArg];
+
+        spec[n++] = *fmt;
+        spec[n] = '\0';
+        dot = strchr(spec, '.');
+        for (n = (dot != NULL)? atoi(dot + 1): 0; n > 0; --n)
+        {
+          value /= 10.0;
+        }
+        printf(spec, value);
+      }
+      else
+      {
+        printf("%ld", args[iArg]);
+      }
+      iArg++;
+      fmt++;
+    }
+  }
+
+  return;
+}   //PrintFormat
+
+/// <summary>
+///   This function parses the hex words of a trace record. Each word is
+///   four hex digits with nothing in between.
+/// </summary>
+///
+/// <param name="rec">
+///   Specifies the record text after the '@'.
+/// </param>
+/// <param name="words">
+///   Receives the REC_WORDS words.
+/// </param>
+///
+/// <returns> Returns 1 if the record is well formed, 0 otherwise. </returns>
+
+static int
+ParseWords(
+  const char *rec,
+  unsigned long *words
+  )
+{
+  int i;
+
+  if (strlen(rec) != REC_WORDS*4)
+  {
+    return 0;
+  }
+
+  for (i = 0; i < REC_WORDS*4; ++i)
+  {
+    int c = (unsigned char)rec[i];
+
+    if (!isxdigit(c))
+    {
+      return 0;
+    }
+    else if (i%4 == 0)
+    {
+      words[i/4] = 0;
+    }
+    words[i/4] = (words[i/4] << 4) |
+                 (isdigit(c)? c - '0': tolower(c) - 'a' + 10);
+  }
+
+  return 1;
+}   //ParseWords
+
+/// <summary>
+///   This function decodes one trace record and prints it in the same
+///   layout as the text backend of trace.h.
+/// </summary>
+///
+/// <param name="rec">
+///   Specifies the record text after the '@'.
+/// </param>
+///
+/// <returns> None. </returns>
+
+static void
+DecodeRecord(
+  const char *rec
+  )
+{
+  unsigned long words[REC_WORDS];
+  long idFunc, args[3];
+  long time;
+  int line, kind, nArgs;
+  FUNC *func;
+  char name[MAX_NAME_LEN];
+  char fmt[MAX_LINE_LEN];
+  int i;
+
+  if (rec[0] == '!')
+  {
+    printf("<%ld records dropped>\n", strtol(rec + 1, NULL, 10));
+    return;
+  }
+  else if (!ParseWords(rec, words))
+  {
+    printf("<bad record: %s>\n", rec);
+    return;
+  }
+
+  idFunc = words[0];
+  line = (short)words[1];
+  kind = words[2] >> 8;
+  nArgs = words[2] & 0xff;
+  time = (long)(int)((words[3] << 16) | words[4]);
+  for (i = 0; i < 3; ++i)
+  {
+    args[i] = (short)words[5 + i];
+  }
+
+  func = FindFunc(idFunc);
+  if (func != NULL)
+  {
+    FindFuncName(func->src, func->line, name);
+    FindFormat(func->src, func->line + line, fmt);
+  }
+  else
+  {
+    sprintf(name, "Func%lx:%d", idFunc, line);
+    fmt[0] = '\0';
+  }
+
+  if (g_fTimestamp)
+  {
+    printf("[%8ld] ", time);
+  }
+
+  if (kind == TRACEREC_ENTER)
+  {
+    g_IndentLevel++;
+  }
+
+  if (kind < TRACEREC_MSG)
+  {
+    for (i = 0; i < g_IndentLevel; ++i)
+    {
+      fputs("| ", stdout);
+    }
+    printf("%s%s", name, (kind == TRACEREC_ENTER)? ": ": "! ");
+  }
+  else
+  {
+    int level = kind - TRACEREC_MSG;
+
+    printf("%s%s", name,
+           ((level >= 0) && (level < 5))? g_MsgNames[level]: "_Unk:");
+  }
+
+  if (nArgs > 0 || kind >= TRACEREC_MSG)
+  {
+    PrintFormat(fmt, args, nArgs);
+  }
+  putchar('\n');
+
+  if ((kind == TRACEREC_EXIT) && (g_IndentLevel > 0))
+  {
+    g_IndentLevel--;
+  }
+
+  return;
+}   //DecodeRecord
+
+/// <summary>
+///   This function is the program entry point.
+/// </summary>
+///
+/// <param name="argc">
+///   Specifies the number of arguments.
+/// </param>
+/// <param name="argv">
+///   Specifies the arguments.
+/// </param>
+///
+/// <returns> Returns 0 on success. </returns>
+
+int
+main(
+  int argc,
+  char **argv
+  )
+{
+  FILE *log;
+  char buff[MAX_LINE_LEN];
+  int i = 1;
+
+  if ((argc > 1) && (strcmp(argv[1], "-t") == 0))
+  {
+    g_fTimestamp = 1;
+    i++;
+  }
+
+  if (argc - i < 2)
+  {
+    fprintf(stderr, "usage: tracedec [-t] <logfile> <source files...>\n");
+    return 1;
+  }
+
+  for (int j = i + 1; j < argc; ++j)
+  {
+    LoadSource(argv[j]);
+  }
+
+  ResolveFuncs();
+
+  log = (strcmp(argv[i], "-") == 0)? stdin: fopen(argv[i], "r");
+  if (log == NULL)
+  {
+    fprintf(stderr, "tracedec: cannot open %s\n", argv[i]);
+    return 1;
+  }
+
+  while (fgets(buff, sizeof(buff), log) != NULL)
+  {
+    //
+    // The robot ends its lines with "\n\r", so the '\r' of the previous
+    // line is at the start of this one.
+    //
+    char *p = buff + strspn(buff, "\r");
+
+    p[strcspn(p, "\r\n")] = '\0';
+    if (p[0] == '@')
+    {
+      DecodeRecord(p + 1);
+    }
+    else if (p[0] != '\0')
+    {
+      puts(p);
+    }
+  }
+
+  if (log != stdin)
+  {
+    fclose(log);
+  }
+
+  return 0;
+}   //main